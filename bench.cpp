@@ -0,0 +1,279 @@
+#include "bench.h"
+#include "simulator.h"
+#include "workload.h"
+#include <iomanip>
+#include <ctime>
+
+namespace {
+
+// --- Conjunto Fixo de Cargas e Maquinas ---
+// Mudar estas listas invalida os baselines gravados (os ciclos deixam de bater).
+
+struct BenchWorkload {
+    const char* name;
+    const char* params;     // "chave=valor" separados por espaco (ver WorkloadParams)
+};
+
+const BenchWorkload SUITE[] = {
+    {"serial", "chains=1 depth=1000000000 mix=add=3,sub=1,mul=1"},
+    {"ilp",    "chains=16 depth=4 mix=add=3,sub=1,mul=2"},
+    {"div",    "chains=4 depth=8 mix=add=2,mul=1,div=2"},
+    {"memory", "chains=8 depth=4 mix=add=2,load=4,store=2 footprint=65536 locality=0.5 alias=0"},
+    {"alias",  "chains=4 depth=8 mix=add=2,load=3,store=3 footprint=512 alias=0.5"},
+    {"mixed",  ""},
+};
+
+struct BenchMachine {
+    const char* name;
+    const char* settings;   // chaves da configuracao, separadas por espaco
+};
+
+const BenchMachine MACHINES[] = {
+    {"original", ""},
+    {"wide", "issue_width=4 cdb_count=4 cdb_arbitration=oldest rob_size=64 commit_width=4 add_rs=8 mul_rs=8 ls_buffers=8"},
+};
+
+struct BenchResult {
+    std::string workload;
+    std::string machine;
+    long instructions = 0;
+    long cycles = 0;
+    double seconds = 0.0;
+
+    double inst_per_second() const { return seconds > 0 ? instructions / seconds : 0.0; }
+    double cycles_per_second() const { return seconds > 0 ? cycles / seconds : 0.0; }
+};
+
+// Tempo de CPU da thread: nao conta o tempo em que outros processos (ou o
+// hipervisor) ocupam o nucleo, o que deixa a medida bem mais estavel
+double thread_seconds() {
+    timespec t;
+    clock_gettime(CLOCK_THREAD_CPUTIME_ID, &t);
+    return t.tv_sec + t.tv_nsec * 1e-9;
+}
+
+std::vector<std::string> split_words(const std::string& text) {
+    std::vector<std::string> words;
+    std::istringstream in(text);
+    std::string word;
+    while (in >> word) words.push_back(word);
+    return words;
+}
+
+// --- Baseline (CSV) ---
+
+bool save_baseline(const std::string& filename, const std::vector<BenchResult>& results) {
+    std::ofstream out(filename);
+    if (!out) {
+        std::cerr << "Erro ao criar baseline: " << filename << std::endl;
+        return false;
+    }
+    out << "workload,machine,instructions,cycles,seconds,inst_per_s,cycles_per_s\n";
+    out << std::setprecision(9);
+    for (const BenchResult& r : results) {
+        out << r.workload << "," << r.machine << "," << r.instructions << "," << r.cycles << ","
+            << r.seconds << "," << r.inst_per_second() << "," << r.cycles_per_second() << "\n";
+    }
+    out.flush();
+    if (!out) {
+        std::cerr << "Erro ao gravar baseline: " << filename << std::endl;
+        return false;
+    }
+    return true;
+}
+
+bool load_baseline(const std::string& filename, std::vector<BenchResult>& results) {
+    std::ifstream in(filename);
+    if (!in) {
+        std::cerr << "Erro ao abrir baseline: " << filename << std::endl;
+        return false;
+    }
+    std::string line;
+    int line_no = 0;
+    while (std::getline(in, line)) {
+        ++line_no;
+        if (line_no == 1 || line.empty()) continue;   // cabecalho
+        std::istringstream fields(line);
+        std::string f[7];
+        int n = 0;
+        while (n < 7 && std::getline(fields, f[n], ',')) ++n;
+        BenchResult r;
+        char* end = nullptr;
+        if (n == 7) {
+            r.workload = f[0];
+            r.machine = f[1];
+            r.instructions = std::strtol(f[2].c_str(), &end, 10);
+            r.cycles = std::strtol(f[3].c_str(), &end, 10);
+            r.seconds = std::strtod(f[4].c_str(), &end);
+        }
+        if (n != 7 || r.instructions <= 0 || r.seconds <= 0) {
+            std::cerr << filename << ":" << line_no << ": linha de baseline invalida" << std::endl;
+            return false;
+        }
+        results.push_back(r);
+    }
+    return true;
+}
+
+void print_bench_usage() {
+    std::cerr << "Uso: simulador bench [opcoes]" << std::endl;
+    std::cerr << "  --count N            instrucoes por carga (padrao 200000)" << std::endl;
+    std::cerr << "  --repeat N           execucoes por medida; vale a mais rapida (padrao 5)" << std::endl;
+    std::cerr << "  --only NOME          mede apenas a carga NOME (pode repetir)" << std::endl;
+    std::cerr << "  --save ARQ           grava os resultados como baseline (CSV)" << std::endl;
+    std::cerr << "  --baseline ARQ       compara com um baseline gravado" << std::endl;
+    std::cerr << "  --tolerance PCT      queda de velocidade aceita antes de acusar regressao (padrao 10)" << std::endl;
+    std::cerr << "Cargas:";
+    for (const BenchWorkload& w : SUITE) std::cerr << " " << w.name;
+    std::cerr << std::endl;
+}
+
+}
+
+int run_bench(int argc, char* argv[]) {
+    long count = 200000;
+    long repeat = 5;
+    double tolerance = 10.0;
+    std::string save_file, baseline_file;
+    std::vector<std::string> only;
+
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        bool takes_value = arg == "--count" || arg == "--repeat" || arg == "--only" || arg == "--save"
+                        || arg == "--baseline" || arg == "--tolerance";
+        if (!takes_value) {
+            if (arg != "--help") std::cerr << "Opcao desconhecida: " << arg << std::endl;
+            print_bench_usage();
+            return arg == "--help" ? EXIT_SUCCESS : EXIT_FAILURE;
+        }
+        if (i + 1 >= argc) {
+            std::cerr << "Opcao " << arg << " exige um valor" << std::endl;
+            return EXIT_FAILURE;
+        }
+        std::string value = argv[++i];
+        char* end = nullptr;
+        if (arg == "--only") only.push_back(value);
+        else if (arg == "--save") save_file = value;
+        else if (arg == "--baseline") baseline_file = value;
+        else if (arg == "--tolerance") {
+            tolerance = std::strtod(value.c_str(), &end);
+            if (end == value.c_str() || *end != '\0' || tolerance < 0 || tolerance >= 100) {
+                std::cerr << "Valor invalido para --tolerance (0 a 100): " << value << std::endl;
+                return EXIT_FAILURE;
+            }
+        } else {
+            long n = std::strtol(value.c_str(), &end, 10);
+            if (end == value.c_str() || *end != '\0' || n < 1) {
+                std::cerr << "Valor invalido para " << arg << ": " << value << std::endl;
+                return EXIT_FAILURE;
+            }
+            (arg == "--count" ? count : repeat) = n;
+        }
+    }
+    for (const std::string& name : only) {
+        bool known = false;
+        for (const BenchWorkload& w : SUITE) known = known || name == w.name;
+        if (!known) {
+            std::cerr << "Carga desconhecida: " << name << std::endl;
+            print_bench_usage();
+            return EXIT_FAILURE;
+        }
+    }
+
+    std::vector<BenchResult> baseline;
+    if (!baseline_file.empty() && !load_baseline(baseline_file, baseline)) return EXIT_FAILURE;
+
+    // Maquinas: configuracao padrao + ajustes, sem limite de ciclos
+    std::vector<SimConfig> configs;
+    for (const BenchMachine& m : MACHINES) {
+        SimConfig config;
+        config.apply("max_cycles=0", "bench");
+        for (const std::string& setting : split_words(m.settings)) {
+            if (!config.apply(setting, std::string("bench/") + m.name)) return EXIT_FAILURE;
+        }
+        configs.push_back(config);
+    }
+
+    std::cout << std::left << std::setw(8) << "carga" << " " << std::setw(9) << "maquina" << std::right
+              << std::setw(11) << "instrucoes" << std::setw(11) << "ciclos" << std::setw(10) << "segundos"
+              << std::setw(11) << "Minstr/s" << std::setw(11) << "Mciclos/s";
+    if (!baseline.empty()) std::cout << std::setw(11) << "baseline" << std::setw(9) << "varia";
+    std::cout << std::endl;
+
+    std::vector<BenchResult> results;
+    int regressions = 0, changed = 0;
+    for (const BenchWorkload& w : SUITE) {
+        if (!only.empty() && std::find(only.begin(), only.end(), w.name) == only.end()) continue;
+
+        // Carga gerada em memoria, compartilhada pelas maquinas
+        WorkloadParams params;
+        params.count = count;
+        for (const std::string& setting : split_words(w.params)) {
+            if (!params.set(setting)) return EXIT_FAILURE;
+        }
+        std::shared_ptr<Program> program(new Program());
+        program->name = w.name;
+        generate_workload(params, program->code);
+        program->records = program->code.data();
+        program->size = program->code.size();
+        registers_used(program->records, program->size, program->f_regs, program->r_regs);
+
+        for (size_t m = 0; m < configs.size(); ++m) {
+            BenchResult r;
+            r.workload = w.name;
+            r.machine = MACHINES[m].name;
+            r.instructions = (long)program->size;
+            for (long k = 0; k < repeat; ++k) {
+                Simulator sim(configs[m], MODE_SILENT);
+                if (!sim.init_memory()) return EXIT_FAILURE;
+                if (!sim.open_program(program)) return EXIT_FAILURE;
+                double start = thread_seconds();
+                sim.run();
+                double seconds = thread_seconds() - start;
+                if (k == 0 || seconds < r.seconds) r.seconds = seconds;
+                r.cycles = sim.get_stats().cycles;
+            }
+
+            std::cout << std::left << std::setw(8) << r.workload << " " << std::setw(9) << r.machine << std::right
+                      << std::setw(11) << r.instructions << std::setw(11) << r.cycles
+                      << std::fixed << std::setprecision(4) << std::setw(10) << r.seconds
+                      << std::setprecision(2) << std::setw(11) << r.inst_per_second() / 1e6
+                      << std::setw(11) << r.cycles_per_second() / 1e6;
+
+            // Comparacao: mesma carga e maquina, mesmo numero de instrucoes
+            if (!baseline.empty()) {
+                const BenchResult* base = nullptr;
+                for (const BenchResult& b : baseline) {
+                    if (b.workload == r.workload && b.machine == r.machine && b.instructions == r.instructions) base = &b;
+                }
+                if (base == nullptr) {
+                    std::cout << std::setw(11) << "-" << std::setw(9) << "-" << "  sem baseline";
+                } else {
+                    double ratio = r.inst_per_second() / base->inst_per_second();
+                    std::cout << std::setw(11) << base->inst_per_second() / 1e6 << std::showpos
+                              << std::setw(8) << (ratio - 1.0) * 100.0 << "%" << std::noshowpos;
+                    if (base->cycles != r.cycles) {
+                        std::cout << "  CICLOS MUDARAM (baseline " << base->cycles << ")";
+                        ++changed;
+                    } else if (ratio < 1.0 - tolerance / 100.0) {
+                        std::cout << "  REGRESSAO";
+                        ++regressions;
+                    }
+                }
+            }
+            std::cout << std::endl;
+            results.push_back(r);
+        }
+    }
+
+    if (!save_file.empty()) {
+        if (!save_baseline(save_file, results)) return EXIT_FAILURE;
+        std::cout << "Baseline gravado em " << save_file << std::endl;
+    }
+    if (regressions > 0 || changed > 0) {
+        std::cout << regressions << " regressao(oes) de velocidade acima de " << std::setprecision(0) << tolerance << "%, "
+                  << changed << " medida(s) com ciclos simulados diferentes do baseline" << std::endl;
+        return EXIT_FAILURE;
+    }
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,12 @@
+#ifndef BENCH_H
+#define BENCH_H
+
+// --- Medicao de Velocidade do Simulador (subcomando "bench") ---
+// Gera um conjunto fixo de cargas sinteticas (ver workload.h), simula cada uma
+// em algumas maquinas e reporta instrucoes e ciclos simulados por segundo.
+// Os resultados podem ser gravados como baseline e comparados com ele depois:
+// queda de velocidade alem da tolerancia, ou ciclos simulados diferentes,
+// fazem o comando falhar. argv[0] e o proprio "bench".
+int run_bench(int argc, char* argv[]);
+
+#endif // BENCH_H
@@ -0,0 +1,154 @@
+#include "cache.h"
+#include "checkpoint.h"
+#include <algorithm>
+
+void Cache::configure(const CacheParams& params) {
+    p = params;
+    sets = (p.size > 0) ? p.size / ((long)p.line * p.assoc) : 0;
+    long ways = sets * p.assoc;
+    tag.assign(ways, 0);
+    valid.assign(ways, false);
+    dirty.assign(ways, false);
+    last_use.assign(ways, 0);
+    fill.assign(ways, 0);
+    mshr.clear();
+    clock = 0;
+    stats = CacheStats();
+}
+
+int Cache::find(uint64_t address) const {
+    uint64_t line = line_of(address);
+    long base = set_of(line) * p.assoc;
+    for (int w = 0; w < p.assoc; ++w) {
+        if (valid[base + w] && tag[base + w] == line) return (int)(base + w);
+    }
+    return -1;
+}
+
+void Cache::touch(int way_index, bool write) {
+    last_use[way_index] = ++clock;
+    if (write) dirty[way_index] = true;
+}
+
+// Via invalida, senao a menos usada recentemente entre as que nao estao em transito
+int Cache::victim(long set, long now) const {
+    long base = set * p.assoc;
+    int best = -1;
+    for (int w = 0; w < p.assoc; ++w) {
+        long i = base + w;
+        if (!valid[i]) return (int)i;
+        if (fill[i] > now) continue;
+        if (best < 0 || last_use[i] < last_use[best]) best = (int)i;
+    }
+    return best;
+}
+
+void Cache::release_mshrs(long now) {
+    mshr.erase(std::remove_if(mshr.begin(), mshr.end(), [now](int64_t t) { return t <= now; }), mshr.end());
+}
+
+bool Cache::can_allocate(uint64_t address, long now) {
+    release_mshrs(now);
+    return (long)mshr.size() < p.mshrs && victim(set_of(line_of(address)), now) >= 0;
+}
+
+void Cache::allocate(uint64_t address, long now, long ready, bool write) {
+    uint64_t line = line_of(address);
+    int i = victim(set_of(line), now);
+    if (valid[i] && dirty[i]) stats.writebacks++;
+    tag[i] = line;
+    valid[i] = true;
+    dirty[i] = write;
+    last_use[i] = ++clock;
+    fill[i] = ready;
+    mshr.push_back(ready);
+}
+
+
+// --- Hierarquia ---
+
+void CacheHierarchy::configure(const CacheParams& l1_params, const CacheParams& l2_params, int mem_latency) {
+    l1.configure(l1_params);
+    l2.configure(l2_params);
+    memory_latency = mem_latency;
+}
+
+int CacheHierarchy::access(long address, bool write, long now) {
+    uint64_t a = (uint64_t)address;
+    long hit1 = l1.params().latency;
+
+    int way = l1.find(a);
+    if (way >= 0) {
+        l1.stats.accesses++;
+        l1.touch(way, write);
+        long ready = l1.fill_time(way);
+        if (ready <= now) {
+            l1.stats.hits++;
+            return (int)hit1;
+        }
+        l1.stats.mshr_merges++;
+        return (int)std::max(hit1, ready - now);
+    }
+
+    // Falha no L1: reserva os recursos de todos os niveis antes de alterar qualquer um
+    if (!l1.can_allocate(a, now)) {
+        l1.stats.mshr_stalls++;
+        return -1;
+    }
+    long below = memory_latency;
+    if (l2.enabled()) {
+        long hit2 = l2.params().latency;
+        long at = now + hit1;   // o L2 e consultado depois do tempo de acerto do L1
+        int way2 = l2.find(a);
+        if (way2 >= 0) {
+            l2.stats.accesses++;
+            l2.touch(way2, false);
+            long ready = l2.fill_time(way2);
+            if (ready <= at) {
+                l2.stats.hits++;
+                below = hit2;
+            } else {
+                l2.stats.mshr_merges++;
+                below = std::max(hit2, ready - at);
+            }
+        } else {
+            if (!l2.can_allocate(a, now)) {
+                l2.stats.mshr_stalls++;
+                return -1;
+            }
+            l2.stats.accesses++;
+            l2.stats.misses++;
+            below = hit2 + memory_latency;
+            l2.allocate(a, now, at + below, false);
+        }
+    }
+
+    long total = hit1 + below;
+    l1.stats.accesses++;
+    l1.stats.misses++;
+    l1.allocate(a, now, now + total, write);
+    return (int)total;
+}
+
+
+// --- Checkpoint ---
+
+void Cache::save(CheckpointWriter& w) const {
+    w.put<uint64_t>(clock);
+    w.put_vector(tag);
+    w.put_vector(valid);
+    w.put_vector(dirty);
+    w.put_vector(last_use);
+    w.put_vector(fill);
+    w.put_vector(mshr);
+    w.put(stats);
+}
+
+// A geometria vem da configuracao atual (conferida no cabecalho do checkpoint)
+bool Cache::load(CheckpointReader& r) {
+    uint64_t c = 0;
+    if (!r.get(c)) return false;
+    clock = c;
+    return r.get_exact(tag) && r.get_exact(valid) && r.get_exact(dirty) && r.get_exact(last_use) &&
+           r.get_exact(fill) && r.get_vector(mshr, 65535) && r.get(stats);
+}
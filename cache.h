@@ -0,0 +1,94 @@
+#ifndef CACHE_H
+#define CACHE_H
+
+#include <vector>
+#include <string>
+#include <cstdint>
+
+class CheckpointWriter;
+class CheckpointReader;
+
+// --- Parametros de um Nivel de Cache ---
+// size = 0 desliga o nivel. Os enderecos do trace sao tratados como
+// enderecos de byte (cada LOAD/STORE toca uma unica linha).
+struct CacheParams {
+    long size = 0;      // capacidade em bytes
+    int assoc = 4;      // vias por conjunto
+    int line = 64;      // bytes por linha
+    int latency = 1;    // ciclos de um acerto
+    int mshrs = 4;      // falhas pendentes simultaneas (nao bloqueantes)
+};
+
+// Contadores de um nivel
+struct CacheStats {
+    long accesses = 0;
+    long hits = 0;
+    long misses = 0;
+    long mshr_merges = 0;   // acessos a uma linha ainda em transito (juntados ao MSHR)
+    long writebacks = 0;    // linhas sujas substituidas
+    long mshr_stalls = 0;   // tentativas adiadas por falta de MSHR ou de via livre
+};
+
+// --- Cache Associativo por Conjunto (LRU, write-back, write-allocate) ---
+// So modela o tempo: os valores continuam na PagedMemory. Uma falha aloca a
+// linha na hora, marcada com o ciclo em que os dados chegam, e ocupa um MSHR
+// ate la; acessos a linha antes disso esperam a mesma chegada.
+class Cache {
+public:
+    void configure(const CacheParams& params);
+    bool enabled() const { return sets > 0; }
+    const CacheParams& params() const { return p; }
+
+    // Via que contem o endereco (-1 = falha)
+    int find(uint64_t address) const;
+    long fill_time(int way_index) const { return fill[way_index]; }
+    void touch(int way_index, bool write);
+
+    // Ha MSHR livre e uma via substituivel (que nao esteja em transito) no ciclo 'now'?
+    bool can_allocate(uint64_t address, long now);
+    // Aloca a linha com os dados chegando em 'ready'
+    void allocate(uint64_t address, long now, long ready, bool write);
+
+    CacheStats stats;
+
+    void save(CheckpointWriter& w) const;
+    bool load(CheckpointReader& r);
+
+private:
+    CacheParams p;
+    long sets = 0;
+    uint64_t clock = 0;             // carimbo de LRU
+
+    // Vias, indexadas por conjunto * assoc + via
+    std::vector<uint64_t> tag;
+    std::vector<char> valid;
+    std::vector<char> dirty;
+    std::vector<uint64_t> last_use;
+    std::vector<int64_t> fill;      // ciclo em que os dados da linha chegam
+    std::vector<int64_t> mshr;      // ciclos de chegada das falhas pendentes
+
+    uint64_t line_of(uint64_t address) const { return address / (uint64_t)p.line; }
+    long set_of(uint64_t line) const { return (long)(line % (uint64_t)sets); }
+    int victim(long set, long now) const;
+    void release_mshrs(long now);
+};
+
+// --- Hierarquia L1 -> L2 -> Memoria ---
+class CacheHierarchy {
+public:
+    // l2.size = 0: as falhas do L1 vao direto a memoria (memory_latency)
+    void configure(const CacheParams& l1, const CacheParams& l2, int memory_latency);
+    bool enabled() const { return l1.enabled(); }
+
+    // Latencia do acesso iniciado no ciclo 'now'; -1 se nao ha MSHR livre
+    // (o acesso deve ser tentado de novo no proximo ciclo)
+    int access(long address, bool write, long now);
+
+    Cache l1;
+    Cache l2;
+
+private:
+    int memory_latency = 0;
+};
+
+#endif // CACHE_H
@@ -0,0 +1,377 @@
+#include "simulator.h"
+#include "checkpoint.h"
+#include <cstring>
+
+// Contadores para os quais 'issue_stall' pode apontar (indice 0 = nenhum)
+static long SimStats::* const STALL_COUNTERS[] = {
+    nullptr,
+    &SimStats::stall_rs_add,
+    &SimStats::stall_rs_mul,
+    &SimStats::stall_ls,
+    &SimStats::stall_rob,
+    &SimStats::stall_window,
+};
+static const int STALL_COUNTER_COUNT = sizeof(STALL_COUNTERS) / sizeof(STALL_COUNTERS[0]);
+
+// Limite de elementos por vetor lido (protege contra arquivos corrompidos)
+static const uint64_t MAX_CHECKPOINT_ITEMS = (uint64_t)1 << 32;
+
+
+// --- Gravacao ---
+
+bool Simulator::save_checkpoint(const std::string& filename) {
+    uint64_t offset = 0;
+    int line = 0;
+    if (!source_done && (source == nullptr || !source->tell(offset, line))) {
+        std::cerr << "Checkpoint indisponivel: o trace precisa ser lido sob demanda (--window)" << std::endl;
+        return false;
+    }
+
+    CheckpointWriter w(filename);
+    if (!w.ok()) {
+        std::cerr << "Erro ao criar checkpoint: " << filename << std::endl;
+        return false;
+    }
+
+    // Cabecalho e forma da maquina (precisa coincidir na restauracao)
+    uint64_t magic;
+    std::memcpy(&magic, CHECKPOINT_MAGIC, sizeof(magic));
+    w.put(magic);
+    w.put<uint32_t>(CHECKPOINT_VERSION);
+    w.put<int32_t>(config.add_rs);
+    w.put<int32_t>(config.mul_rs);
+    w.put<int32_t>(config.ls_buffers);
+    w.put<int32_t>(config.rob_size);
+    for (const CacheParams* c : {&config.l1, &config.l2}) {
+        w.put<int64_t>(c->size);
+        w.put<int32_t>(c->assoc);
+        w.put<int32_t>(c->line);
+    }
+
+    // Posicao no trace e janela de instrucoes
+    w.put<uint64_t>(trace_bytes);
+    w.put<uint8_t>(source_done);
+    w.put<uint64_t>(offset);
+    w.put<int32_t>(line);
+    w.put<int64_t>(window_elastic ? 0 : (int64_t)inst_window.size());
+
+    // Estado escalar
+    w.put<int64_t>(cycle);
+    w.put<int64_t>(pc);
+    w.put<int64_t>(committed_inst_count);
+    w.put<int64_t>(fetched);
+    w.put<uint8_t>(simulation_complete);
+
+    // Instrucoes ainda nao comprometidas (emitidas ou apenas buscadas)
+    w.put<uint64_t>(fetched - committed_inst_count);
+    for (long seq = committed_inst_count; seq < fetched; ++seq) {
+        const Instruction& inst = inst_at(seq);
+        w.put(inst.op);
+        w.put(inst.fu);
+        w.put(inst.latency);
+        w.put(inst.dest);
+        w.put(inst.src1);
+        w.put(inst.src2);
+        w.put(inst.offset);
+        w.put(inst.state);
+        w.put<int64_t>(inst.issue_cycle);
+        w.put<int64_t>(inst.exec_start_cycle);
+        w.put<int64_t>(inst.exec_end_cycle);
+        w.put<int64_t>(inst.write_cycle);
+    }
+
+    // Estacoes de reserva e buffers L/S
+    w.put_vector(rs.busy);
+    w.put_vector(rs.op);
+    w.put_vector(rs.vj);
+    w.put_vector(rs.vk);
+    w.put_vector(rs.qj);
+    w.put_vector(rs.qk);
+    w.put_vector(rs.instruction_id);
+    w.put_vector(rs.cycles_remaining);
+    w.put_vector(rs.result);
+    w.put_vector(rs.ready_to_writeback);
+
+    w.put_vector(ls.busy);
+    w.put_vector(ls.op);
+    w.put_vector(ls.dest_reg);
+    w.put_vector(ls.base_value);
+    w.put_vector(ls.base_producer);
+    w.put_vector(ls.offset);
+    w.put_vector(ls.calculated_address);
+    w.put_vector(ls.address_ready);
+    w.put_vector(ls.store_value);
+    w.put_vector(ls.store_producer);
+    w.put_vector(ls.instruction_id);
+    w.put_vector(ls.cycles_remaining);
+    w.put_vector(ls.result);
+    w.put_vector(ls.ready_to_writeback);
+
+    // ROB (apenas as entradas vivas)
+    w.put<int64_t>(rob.head);
+    w.put<int64_t>(rob.tail);
+    for (long seq = rob.head; seq < rob.tail; ++seq) {
+        const ROB_Entry& entry = rob.at(seq);
+        w.put(entry.value);
+        w.put<int64_t>(entry.address);
+        w.put<int32_t>(entry.producer_tag);
+        w.put<uint8_t>(entry.ready);
+    }
+
+    // Listas de espera do CDB
+    w.put<uint64_t>(waiters.size());
+    for (const std::vector<Waiter>& list : waiters) {
+        w.put<uint64_t>(list.size());
+        for (const Waiter& waiter : list) {
+            w.put<int32_t>(waiter.consumer);
+            w.put<int64_t>(waiter.producer);
+        }
+    }
+
+    // Registradores
+    w.put_vector(reg_file);
+    w.put_vector(reg_status);
+    w.put_vector(reg_producer);
+
+    // Memoria: imagem de origem e celulas escritas (valores iniciais e STOREs)
+    w.put_string(config.mem_image);
+    w.put<int64_t>(config.mem_base);
+    std::vector<std::pair<long, double>> cells = memory.written_cells();
+    std::vector<int64_t> addresses(cells.size());
+    std::vector<double> values(cells.size());
+    for (size_t i = 0; i < cells.size(); ++i) {
+        addresses[i] = cells[i].first;
+        values[i] = cells[i].second;
+    }
+    w.put_vector(addresses);
+    w.put_vector(values);
+
+    // Contadores
+    int stall_index = 0;
+    for (int k = 1; k < STALL_COUNTER_COUNT; ++k) {
+        if (issue_stall == &(stats.*STALL_COUNTERS[k])) stall_index = k;
+    }
+    w.put<uint8_t>(issue_progress);
+    w.put<int32_t>(stall_index);
+    w.put<int64_t>(stats.stall_rs_add);
+    w.put<int64_t>(stats.stall_rs_mul);
+    w.put<int64_t>(stats.stall_ls);
+    w.put<int64_t>(stats.stall_rob);
+    w.put<int64_t>(stats.stall_window);
+    w.put<int64_t>(stats.rob_occupancy_sum);
+    w.put<int64_t>(stats.rob_occupancy_max);
+    w.put<int64_t>(stats.commit_width_limited);
+    w.put<int64_t>(stats.commit_active_cycles);
+    w.put<int64_t>(stats.cdb_conflicts);
+    w.put<int64_t>(stats.cdb_broadcasts);
+    w.put<int64_t>(stats.issued);
+    w.put<int64_t>(stats.issue_width_full);
+    w.put<int64_t>(stats.loads_forwarded);
+    w.put<int64_t>(stats.fast_forwarded);
+    for (int k = 0; k < CPI_COUNT; ++k) w.put<int64_t>(stats.cpi[k]);
+    w.put_vector(stats.stations);
+    caches.l1.save(w);
+    caches.l2.save(w);
+
+    if (!w.finish()) {
+        std::cerr << "Erro ao gravar checkpoint: " << filename << std::endl;
+        return false;
+    }
+    return true;
+}
+
+
+// --- Restauracao ---
+
+bool Simulator::restore_checkpoint(const std::string& filename, const std::string& trace) {
+    CheckpointReader r(filename);
+    if (!r.ok()) {
+        std::cerr << "Erro ao abrir checkpoint: " << filename << std::endl;
+        return false;
+    }
+    auto corrupt = [&filename]() {
+        std::cerr << "Checkpoint invalido ou corrompido: " << filename << std::endl;
+        return false;
+    };
+
+    uint64_t magic = 0;
+    uint32_t version = 0;
+    if (!r.get(magic) || std::memcmp(&magic, CHECKPOINT_MAGIC, 8) != 0 || !r.get(version)) return corrupt();
+    if (version != CHECKPOINT_VERSION) {
+        std::cerr << "Versao de checkpoint nao suportada (" << version << "): " << filename << std::endl;
+        return false;
+    }
+
+    int32_t add_rs, mul_rs, ls_buffers, rob_size;
+    if (!r.get(add_rs) || !r.get(mul_rs) || !r.get(ls_buffers) || !r.get(rob_size)) return corrupt();
+    if (add_rs != config.add_rs || mul_rs != config.mul_rs || ls_buffers != config.ls_buffers || rob_size != config.rob_size) {
+        std::cerr << "Checkpoint " << filename << " gravado com outra maquina (add_rs=" << add_rs << ", mul_rs=" << mul_rs
+                  << ", ls_buffers=" << ls_buffers << ", rob_size=" << rob_size << ")" << std::endl;
+        return false;
+    }
+    for (const CacheParams* c : {&config.l1, &config.l2}) {
+        int64_t size = 0;
+        int32_t assoc = 0, line_bytes = 0;
+        if (!r.get(size) || !r.get(assoc) || !r.get(line_bytes)) return corrupt();
+        if (size != c->size || (size > 0 && (assoc != c->assoc || line_bytes != c->line))) {
+            std::cerr << "Checkpoint " << filename << " gravado com outro cache L" << (c == &config.l1 ? 1 : 2)
+                      << " (size=" << size << ", assoc=" << assoc << ", line=" << line_bytes << ")" << std::endl;
+            return false;
+        }
+    }
+
+    uint64_t bytes = 0, offset = 0;
+    uint8_t done = 0, complete = 0;
+    int32_t line = 0;
+    int64_t window = 0, cycle_, pc_, committed_, fetched_;
+    if (!r.get(bytes) || !r.get(done) || !r.get(offset) || !r.get(line) || !r.get(window)) return corrupt();
+    if (!r.get(cycle_) || !r.get(pc_) || !r.get(committed_) || !r.get(fetched_) || !r.get(complete)) return corrupt();
+    if (window < 0 || committed_ < 0 || pc_ < committed_ || fetched_ < pc_) return corrupt();
+
+    // Reabre o trace direto na posicao gravada
+    source.reset();
+    if (!done) {
+        std::unique_ptr<InstructionSource> parser = open_trace(trace);
+        if (!parser) return false;
+        if (parser->size_bytes() != bytes || !parser->seek(offset, line)) {
+            std::cerr << "O trace " << trace << " nao corresponde ao checkpoint " << filename << std::endl;
+            return false;
+        }
+        trace_bytes = bytes;
+        trace_name = trace;
+        source = std::move(parser);
+    }
+    source_done = done;
+    window_elastic = (window == 0);
+
+    cycle = cycle_;
+    pc = pc_;
+    committed_inst_count = committed_;
+    fetched = fetched_;
+    simulation_complete = complete;
+
+    // Instrucoes em voo. A janela elastica comeca com espaco para todas.
+    uint64_t in_flight = 0;
+    if (!r.get(in_flight) || in_flight != (uint64_t)(fetched - committed_inst_count)) return corrupt();
+    if (!window_elastic && in_flight > (uint64_t)window) return corrupt();
+    size_t size = window_elastic ? 64 : (size_t)window;
+    while (size < in_flight) size *= 2;
+    inst_window.assign(size, Instruction());
+    for (long seq = committed_inst_count; seq < fetched; ++seq) {
+        Instruction& inst = inst_at(seq);
+        int64_t issue_c, execs_c, exece_c, write_c;
+        if (!r.get(inst.op) || !r.get(inst.fu) || !r.get(inst.latency) || !r.get(inst.dest) ||
+            !r.get(inst.src1) || !r.get(inst.src2) || !r.get(inst.offset) || !r.get(inst.state) ||
+            !r.get(issue_c) || !r.get(execs_c) || !r.get(exece_c) || !r.get(write_c)) return corrupt();
+        inst.id = seq;
+        inst.issue_cycle = issue_c;
+        inst.exec_start_cycle = execs_c;
+        inst.exec_end_cycle = exece_c;
+        inst.write_cycle = write_c;
+        // Instrucoes que ainda nao iniciaram usam as latencias da configuracao atual
+        if (inst.state == NOT_ISSUED || inst.state == ISSUED) inst.latency = (uint16_t)op_latency(inst.op);
+    }
+
+    bool ok = r.get_exact(rs.busy) && r.get_exact(rs.op) && r.get_exact(rs.vj) && r.get_exact(rs.vk) &&
+              r.get_exact(rs.qj) && r.get_exact(rs.qk) && r.get_exact(rs.instruction_id) &&
+              r.get_exact(rs.cycles_remaining) && r.get_exact(rs.result) && r.get_exact(rs.ready_to_writeback);
+    ok = ok && r.get_exact(ls.busy) && r.get_exact(ls.op) && r.get_exact(ls.dest_reg) &&
+         r.get_exact(ls.base_value) && r.get_exact(ls.base_producer) && r.get_exact(ls.offset) &&
+         r.get_exact(ls.calculated_address) && r.get_exact(ls.address_ready) && r.get_exact(ls.store_value) &&
+         r.get_exact(ls.store_producer) && r.get_exact(ls.instruction_id) && r.get_exact(ls.cycles_remaining) &&
+         r.get_exact(ls.result) && r.get_exact(ls.ready_to_writeback);
+    if (!ok) return corrupt();
+
+    // ROB: as entradas voltam para a mesma posicao circular
+    int64_t head = 0, tail = 0;
+    if (!r.get(head) || !r.get(tail) || head != committed_inst_count || tail < head) return corrupt();
+    rob.configure(config.rob_size);
+    if (rob.capacity > 0 && tail - head > rob.capacity) return corrupt();
+    while ((int64_t)rob.entries.size() < tail - head) rob.entries.resize(rob.entries.size() * 2);
+    rob.head = rob.tail = head;
+    for (long seq = head; seq < tail; ++seq) {
+        ROB_Entry& entry = rob.allocate();
+        int64_t address;
+        int32_t producer;
+        uint8_t ready;
+        if (!r.get(entry.value) || !r.get(address) || !r.get(producer) || !r.get(ready)) return corrupt();
+        entry.address = address;
+        entry.producer_tag = producer;
+        entry.ready = ready;
+    }
+
+    uint64_t lists = 0;
+    if (!r.get(lists) || lists != waiters.size()) return corrupt();
+    for (std::vector<Waiter>& list : waiters) {
+        uint64_t n = 0;
+        if (!r.get(n) || n > MAX_CHECKPOINT_ITEMS) return corrupt();
+        list.resize((size_t)n);
+        for (Waiter& waiter : list) {
+            int32_t consumer;
+            int64_t producer;
+            if (!r.get(consumer) || !r.get(producer)) return corrupt();
+            waiter.consumer = consumer;
+            waiter.producer = producer;
+        }
+    }
+
+    if (!r.get_exact(reg_file) || !r.get_exact(reg_status) || !r.get_exact(reg_producer)) return corrupt();
+
+    // Memoria: remapeia a imagem e reaplica as celulas escritas
+    std::string image;
+    int64_t base = 0;
+    std::vector<int64_t> addresses;
+    std::vector<double> values;
+    if (!r.get_string(image, 4096) || !r.get(base) ||
+        !r.get_vector(addresses, MAX_CHECKPOINT_ITEMS) || !r.get_vector(values, MAX_CHECKPOINT_ITEMS) ||
+        addresses.size() != values.size()) return corrupt();
+    memory.clear();
+    if (!image.empty() && !memory.load_image(image, base)) return false;
+    config.mem_image = image;
+    config.mem_base = base;
+    for (size_t i = 0; i < addresses.size(); ++i) memory.write(addresses[i], values[i]);
+
+    uint8_t progress = 0;
+    int32_t stall_index = 0;
+    int64_t counters[15];
+    if (!r.get(progress) || !r.get(stall_index) || stall_index < 0 || stall_index >= STALL_COUNTER_COUNT) return corrupt();
+    for (int64_t& c : counters) {
+        if (!r.get(c)) return corrupt();
+    }
+    for (int k = 0; k < CPI_COUNT; ++k) {
+        int64_t c;
+        if (!r.get(c)) return corrupt();
+        stats.cpi[k] = c;
+    }
+    if (!r.get_exact(stats.stations) || !caches.l1.load(r) || !caches.l2.load(r) || !r.at_end()) return corrupt();
+
+    issue_progress = progress;
+    issue_stall = stall_index > 0 ? &(stats.*STALL_COUNTERS[stall_index]) : nullptr;
+    stats.stall_rs_add = counters[0];
+    stats.stall_rs_mul = counters[1];
+    stats.stall_ls = counters[2];
+    stats.stall_rob = counters[3];
+    stats.stall_window = counters[4];
+    stats.rob_occupancy_sum = counters[5];
+    stats.rob_occupancy_max = counters[6];
+    stats.commit_width_limited = counters[7];
+    stats.commit_active_cycles = counters[8];
+    stats.cdb_conflicts = counters[9];
+    stats.cdb_broadcasts = counters[10];
+    stats.issued = counters[11];
+    stats.issue_width_full = counters[12];
+    stats.loads_forwarded = counters[13];
+    stats.fast_forwarded = counters[14];
+    rebuild_store_queue();
+    stats.start_cycle = cycle;
+    stats.start_committed = committed_inst_count - stats.fast_forwarded;
+
+    if (verbose) std::cout << "[Inicialização] Checkpoint " << filename << " restaurado no ciclo " << cycle
+                           << " (" << committed_inst_count << " instrucoes comprometidas)" << std::endl;
+    return true;
+}
+
+void Simulator::schedule_checkpoints(long every, const std::string& prefix) {
+    checkpoint_every = every;
+    checkpoint_prefix = prefix;
+}
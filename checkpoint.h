@@ -0,0 +1,94 @@
+#ifndef CHECKPOINT_H
+#define CHECKPOINT_H
+
+#include <string>
+#include <vector>
+#include <fstream>
+#include <cstdint>
+#include <type_traits>
+
+// --- Formato Binario dos Checkpoints ---
+// Sequencia de campos na ordem nativa da maquina (o checkpoint so e lido na
+// mesma plataforma que o gravou). Vetores levam o tamanho (uint64) seguido
+// dos elementos em bloco; strings, o tamanho seguido dos bytes.
+#define CHECKPOINT_MAGIC "TOMACKPT"
+#define CHECKPOINT_VERSION 5
+
+class CheckpointWriter {
+public:
+    explicit CheckpointWriter(const std::string& filename) : out(filename, std::ios::binary) {}
+    bool ok() const { return (bool)out; }
+
+    template <typename T>
+    void put(const T& value) {
+        static_assert(std::is_trivially_copyable<T>::value, "campo de checkpoint deve ser POD");
+        out.write((const char*)&value, sizeof(T));
+    }
+
+    template <typename T>
+    void put_vector(const std::vector<T>& values) {
+        static_assert(std::is_trivially_copyable<T>::value, "campo de checkpoint deve ser POD");
+        put<uint64_t>(values.size());
+        if (!values.empty()) out.write((const char*)values.data(), values.size() * sizeof(T));
+    }
+
+    void put_string(const std::string& text) {
+        put<uint64_t>(text.size());
+        out.write(text.data(), text.size());
+    }
+
+    bool finish() {
+        out.flush();
+        return (bool)out;
+    }
+
+private:
+    std::ofstream out;
+};
+
+class CheckpointReader {
+public:
+    explicit CheckpointReader(const std::string& filename) : in(filename, std::ios::binary) {}
+    bool ok() const { return (bool)in; }
+
+    template <typename T>
+    bool get(T& value) {
+        static_assert(std::is_trivially_copyable<T>::value, "campo de checkpoint deve ser POD");
+        return (bool)in.read((char*)&value, sizeof(T));
+    }
+
+    // Le um vetor com no maximo 'limit' elementos (protege contra arquivos corrompidos)
+    template <typename T>
+    bool get_vector(std::vector<T>& values, uint64_t limit) {
+        static_assert(std::is_trivially_copyable<T>::value, "campo de checkpoint deve ser POD");
+        uint64_t n = 0;
+        if (!get(n) || n > limit) return false;
+        values.resize((size_t)n);
+        if (n == 0) return true;
+        return (bool)in.read((char*)values.data(), n * sizeof(T));
+    }
+
+    // Le um vetor que deve ter exatamente o tamanho atual de 'values'
+    template <typename T>
+    bool get_exact(std::vector<T>& values) {
+        size_t expected = values.size();
+        return get_vector(values, expected) && values.size() == expected;
+    }
+
+    bool get_string(std::string& text, uint64_t limit) {
+        uint64_t n = 0;
+        if (!get(n) || n > limit) return false;
+        text.resize((size_t)n);
+        return n == 0 || (bool)in.read(&text[0], n);
+    }
+
+    // true se todo o arquivo foi consumido
+    bool at_end() {
+        return in.peek() == std::char_traits<char>::eof();
+    }
+
+private:
+    std::ifstream in;
+};
+
+#endif // CHECKPOINT_H
@@ -0,0 +1,313 @@
+#include "config.h"
+#include "trace.h"
+#include <iostream>
+#include <fstream>
+#include <cstdlib>
+#include <cerrno>
+
+// Estado inicial padrao (o mesmo da maquina original)
+SimConfig::SimConfig() {
+    // F0..F8 comecam em 10..18, exceto F1 (endereco base dos LOADs) e F8 (multiplicador)
+    for (int i = 0; i <= 8; ++i) registers[i] = i + 10.0;
+    registers[1] = 100.0;
+    registers[8] = 2.0;
+}
+
+std::map<long, double> SimConfig::initial_memory() const {
+    std::map<long, double> cells;
+    if (default_memory && mem_image.empty()) {
+        cells[132] = 10.0;   // endereço base 100 + offset 32
+        cells[136] = 20.0;   // endereço base 100 + offset 36
+        cells[1000] = 50.0;
+        cells[1004] = 60.0;
+        cells[1008] = 70.0;
+    }
+    for (auto const& cell : memory) cells[cell.first] = cell.second;
+    return cells;
+}
+
+static std::string trim(const std::string& s) {
+    size_t b = s.find_first_not_of(" \t\r");
+    if (b == std::string::npos) return "";
+    size_t e = s.find_last_not_of(" \t\r");
+    return s.substr(b, e - b + 1);
+}
+
+static bool to_long(const std::string& text, long& out) {
+    if (text.empty()) return false;
+    char* end = nullptr;
+    errno = 0;
+    out = std::strtol(text.c_str(), &end, 10);
+    return *end == '\0' && errno == 0;
+}
+
+static bool to_double(const std::string& text, double& out) {
+    if (text.empty()) return false;
+    char* end = nullptr;
+    out = std::strtod(text.c_str(), &end);
+    return *end == '\0';
+}
+
+
+// --- Validacao ---
+
+bool SimConfig::validate(const std::string& where) const {
+    bool ok = true;
+    const CacheParams* levels[] = {&l1, &l2};
+    for (int i = 0; i < 2; ++i) {
+        const CacheParams& c = *levels[i];
+        if (c.size == 0) continue;
+        long set_bytes = (long)c.line * c.assoc;
+        if (c.size % set_bytes != 0) {
+            std::cerr << where << ": l" << (i + 1) << "_size (" << c.size << ") deve ser multiplo de linha * vias ("
+                      << set_bytes << ")" << std::endl;
+            ok = false;
+        }
+    }
+    if (l2.size > 0 && l1.size == 0) {
+        std::cerr << where << ": l2_size exige um L1 (l1_size > 0)" << std::endl;
+        ok = false;
+    }
+    for (auto const& reg : registers) {
+        if (register_in_banks(reg.first)) continue;
+        bool f = reg.first < R_REG_BASE;
+        std::cerr << where << ": " << (f ? "F" : "R") << (f ? reg.first : reg.first - R_REG_BASE)
+                  << " fora do banco de registradores (" << (f ? "f_regs = " : "r_regs = ")
+                  << (f ? f_regs : r_regs) << ")" << std::endl;
+        ok = false;
+    }
+    return ok;
+}
+
+
+// --- Leitura do Arquivo ---
+
+bool SimConfig::load_file(const std::string& filename) {
+    std::ifstream file(filename);
+    if (!file) {
+        std::cerr << "Erro ao abrir arquivo de configuracao: " << filename << std::endl;
+        return false;
+    }
+
+    std::string line;
+    int line_no = 0;
+    bool ok = true;
+    while (std::getline(file, line)) {
+        ++line_no;
+        size_t hash = line.find('#');
+        if (hash != std::string::npos) line.erase(hash);
+        if (trim(line).empty()) continue;
+        if (!apply(line, filename + ":" + std::to_string(line_no))) ok = false;
+    }
+    return ok;
+}
+
+// Valores iniciais dos registradores, um por linha: "Fn = valor" ou "Fn valor"
+bool SimConfig::load_registers(const std::string& filename, const std::string& where) {
+    std::ifstream file(filename);
+    if (!file) {
+        std::cerr << where << ": erro ao abrir arquivo de registradores: " << filename << std::endl;
+        return false;
+    }
+
+    std::string line;
+    int line_no = 0;
+    bool ok = true;
+    while (std::getline(file, line)) {
+        ++line_no;
+        size_t hash = line.find('#');
+        if (hash != std::string::npos) line.erase(hash);
+        line = trim(line);
+        if (line.empty()) continue;
+        size_t split = line.find_first_of(" \t=");
+        std::string name = line.substr(0, split);
+        std::string text = (split == std::string::npos) ? "" : trim(line.substr(split));
+        if (!text.empty() && text[0] == '=') text = trim(text.substr(1));
+        int reg = decode_register(name.data(), name.data() + name.size());
+        double v = 0.0;
+        if (reg < 0 || !to_double(text, v)) {
+            std::cerr << filename << ":" << line_no << ": esperado 'Fn = valor' ou 'Rn = valor': " << line << std::endl;
+            ok = false;
+            continue;
+        }
+        registers[reg] = v;
+    }
+    return ok;
+}
+
+bool SimConfig::apply(const std::string& assignment, const std::string& where) {
+    size_t eq = assignment.find('=');
+    if (eq == std::string::npos) {
+        std::cerr << where << ": esperado 'chave = valor': " << trim(assignment) << std::endl;
+        return false;
+    }
+    return set(trim(assignment.substr(0, eq)), trim(assignment.substr(eq + 1)), where);
+}
+
+
+// --- Chaves Reconhecidas ---
+
+bool SimConfig::set(const std::string& key, const std::string& value, const std::string& where) {
+    long n = 0;
+    double v = 0.0;
+
+    // Contagens e latencias (inteiros positivos)
+    struct IntKey { const char* name; int* field; };
+    IntKey positive[] = {
+        {"add_rs", &add_rs}, {"mul_rs", &mul_rs}, {"ls_buffers", &ls_buffers},
+        {"add_latency", &add_latency}, {"mul_latency", &mul_latency},
+        {"div_latency", &div_latency}, {"mem_latency", &mem_latency},
+        {"issue_width", &issue_width},
+    };
+    for (const IntKey& k : positive) {
+        if (key != k.name) continue;
+        if (!to_long(value, n) || n < 1 || n > 65535) {
+            std::cerr << where << ": valor invalido para " << key << " (inteiro de 1 a 65535): " << value << std::endl;
+            return false;
+        }
+        *k.field = (int)n;
+        return true;
+    }
+
+    // Caches: l1_size, l1_assoc, ... (tamanho 0 desliga o nivel)
+    if (key.size() > 3 && (key.compare(0, 3, "l1_") == 0 || key.compare(0, 3, "l2_") == 0)) {
+        CacheParams& level = (key[1] == '1') ? l1 : l2;
+        std::string field = key.substr(3);
+        if (field == "size") {
+            if (!to_long(value, n) || n < 0 || n > (1L << 30)) {
+                std::cerr << where << ": valor invalido para " << key << " (bytes, 0 a 2^30): " << value << std::endl;
+                return false;
+            }
+            level.size = n;
+            return true;
+        }
+        int* target = (field == "assoc") ? &level.assoc : (field == "line") ? &level.line :
+                      (field == "latency") ? &level.latency : (field == "mshrs") ? &level.mshrs : nullptr;
+        if (target != nullptr) {
+            if (!to_long(value, n) || n < 1 || n > 65535) {
+                std::cerr << where << ": valor invalido para " << key << " (inteiro de 1 a 65535): " << value << std::endl;
+                return false;
+            }
+            *target = (int)n;
+            return true;
+        }
+    }
+
+    // Registradores por banco
+    if (key == "f_regs" || key == "r_regs") {
+        if (!to_long(value, n) || n < 32 || n > MAX_BANK_REGS) {
+            std::cerr << where << ": valor invalido para " << key << " (inteiro de 32 a " << MAX_BANK_REGS << "): "
+                      << value << std::endl;
+            return false;
+        }
+        (key == "f_regs" ? f_regs : r_regs) = (int)n;
+        return true;
+    }
+
+    // Limites de execucao (0 = ilimitado)
+    if (key == "max_cycles" || key == "rob_size" || key == "commit_width" || key == "cdb_count") {
+        if (!to_long(value, n) || n < 0 || (key != "max_cycles" && n > 1000000000L)) {
+            std::cerr << where << ": valor invalido para " << key << " (inteiro >= 0): " << value << std::endl;
+            return false;
+        }
+        if (key == "max_cycles") max_cycles = n;
+        else if (key == "rob_size") rob_size = (int)n;
+        else if (key == "cdb_count") cdb_count = (int)n;
+        else commit_width = (int)n;
+        return true;
+    }
+
+    if (key == "fast_forward" && value == "roi") {
+        fast_forward = -1;
+        return true;
+    }
+    if (key == "fast_forward" || key == "warmup") {
+        if (!to_long(value, n) || n < 0) {
+            std::cerr << where << ": valor invalido para " << key << " (inteiro >= 0"
+                      << (key == "fast_forward" ? " ou roi" : "") << "): " << value << std::endl;
+            return false;
+        }
+        (key == "fast_forward" ? fast_forward : warmup) = n;
+        return true;
+    }
+
+    if (key == "cycle_skip" || key == "store_forwarding") {
+        if (value != "0" && value != "1") {
+            std::cerr << where << ": valor invalido para " << key << " (0 ou 1): " << value << std::endl;
+            return false;
+        }
+        (key == "cycle_skip" ? cycle_skip : store_forwarding) = (value == "1");
+        return true;
+    }
+
+    if (key == "cdb_arbitration") {
+        if (value == "station") cdb_arbitration = CDB_STATION_ORDER;
+        else if (value == "oldest") cdb_arbitration = CDB_OLDEST_FIRST;
+        else {
+            std::cerr << where << ": valor invalido para cdb_arbitration (station ou oldest): " << value << std::endl;
+            return false;
+        }
+        return true;
+    }
+
+    if (key == "log_level") {
+        if (value == "off") log_level = LOG_OFF;
+        else if (value == "summary") log_level = LOG_SUMMARY;
+        else if (value == "events") log_level = LOG_EVENTS;
+        else {
+            std::cerr << where << ": valor invalido para log_level (off, summary ou events): " << value << std::endl;
+            return false;
+        }
+        return true;
+    }
+
+    if (key == "mem_image") {
+        mem_image = value;
+        return true;
+    }
+    if (key == "mem_base") {
+        if (!to_long(value, mem_base)) {
+            std::cerr << where << ": valor invalido para mem_base: " << value << std::endl;
+            return false;
+        }
+        return true;
+    }
+
+    // "registers = clear" / "memory = clear" descartam os valores iniciais padrao
+    if ((key == "registers" || key == "memory") && value == "clear") {
+        if (key == "registers") {
+            registers.clear();
+        } else {
+            memory.clear();
+            default_memory = false;
+        }
+        return true;
+    }
+
+    if (key == "registers_file") return load_registers(value, where);
+
+    // mem[endereco] = valor
+    if (key.size() > 5 && key.compare(0, 4, "mem[") == 0 && key.back() == ']') {
+        long address = 0;
+        if (!to_long(trim(key.substr(4, key.size() - 5)), address) || !to_double(value, v)) {
+            std::cerr << where << ": atribuicao de memoria invalida: " << key << " = " << value << std::endl;
+            return false;
+        }
+        memory[address] = v;
+        return true;
+    }
+
+    // Fn / Rn = valor
+    int reg = decode_register(key.data(), key.data() + key.size());
+    if (reg >= 0) {
+        if (!to_double(value, v)) {
+            std::cerr << where << ": valor invalido para " << key << ": " << value << std::endl;
+            return false;
+        }
+        registers[reg] = v;
+        return true;
+    }
+
+    std::cerr << where << ": chave de configuracao desconhecida: " << key << std::endl;
+    return false;
+}
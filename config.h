@@ -0,0 +1,99 @@
+#ifndef CONFIG_H
+#define CONFIG_H
+
+#include <string>
+#include <map>
+#include "cache.h"
+#include "eventlog.h"
+#include "trace.h"
+
+// Arbitragem do CDB quando ha mais estacoes prontas que barramentos
+enum CdbArbitration {
+    CDB_STATION_ORDER,  // ordem fixa das estacoes (Add -> Mult -> L/S), como na maquina original
+    CDB_OLDEST_FIRST    // instrucao mais antiga (menor id) primeiro
+};
+
+// --- Configuracao da Maquina Simulada ---
+// Lida na inicializacao (arquivo + sobrescritas da linha de comando) e passada
+// ao Simulator; os valores padrao reproduzem a maquina original.
+struct SimConfig {
+    // Estacoes de reserva e buffers
+    int add_rs = 3;         // ADD/SUB
+    int mul_rs = 2;         // MUL/DIV
+    int ls_buffers = 2;     // LOAD/STORE
+
+    // Latencias das unidades funcionais (em ciclos)
+    int add_latency = 2;    // ADD e SUB
+    int mul_latency = 10;
+    int div_latency = 40;
+    int mem_latency = 3;
+
+    // Largura do pipeline
+    int issue_width = 1;    // instrucoes emitidas por ciclo
+    int cdb_count = 0;      // barramentos compartilhados (0 = um para as RS e um para os L/S)
+    CdbArbitration cdb_arbitration = CDB_STATION_ORDER;
+    bool store_forwarding = true;   // LOAD recebe o valor de um STORE mais antigo em voo
+
+    // Hierarquia de caches (l1.size = 0: sem cache, todo acesso custa mem_latency;
+    // com cache, mem_latency e o custo de uma falha no ultimo nivel)
+    CacheParams l1;
+    CacheParams l2;
+
+    // Execucao
+    long max_cycles = 500;  // 0 = sem limite
+    int rob_size = 0;       // 0 = ilimitado
+    int commit_width = 0;   // 0 = ilimitado
+    bool cycle_skip = true; // pula ciclos ociosos fora do modo interativo
+    LogLevel log_level = LOG_EVENTS;    // log na tela (modo interativo) ou em --log-out
+
+    // Regiao medida: as primeiras 'fast_forward' instrucoes (-1 = ate o marcador
+    // #@roi do trace) so atualizam registradores e memoria, sem ciclos; depois,
+    // 'warmup' instrucoes passam pelo pipeline antes do intervalo medido comecar
+    long fast_forward = 0;
+    long warmup = 0;
+
+    // Bancos de registradores arquiteturais: F0..F(f_regs-1) e R0..R(r_regs-1),
+    // de 32 a 128 cada. Um trace com registradores fora dos bancos nao e carregado.
+    int f_regs = 128;
+    int r_regs = 128;
+
+    // Estado inicial: registrador (indice decodificado) -> valor e endereco -> valor.
+    // Os valores padrao de memoria so valem sem imagem e sem "memory = clear".
+    std::map<int, double> registers;
+    std::map<long, double> memory;
+    bool default_memory = true;
+    std::string mem_image;  // imagem binaria opcional (aplicada antes de 'memory')
+    long mem_base = 0;
+
+    SimConfig();
+
+    // Le um arquivo "chave = valor" (comentarios com '#'). Erros sao
+    // reportados como arquivo:linha e a leitura falha.
+    bool load_file(const std::string& filename);
+
+    // Aplica uma sobrescrita "chave=valor" (ex.: --set add_rs=4).
+    // 'where' identifica a origem nas mensagens de erro.
+    bool apply(const std::string& assignment, const std::string& where);
+
+    // Verifica combinacoes que dependem de mais de uma chave (ex.: geometria
+    // dos caches). Chamada depois de todas as sobrescritas.
+    bool validate(const std::string& where) const;
+
+    // Celulas a escrever na inicializacao (padrao + atribuicoes mem[...])
+    std::map<long, double> initial_memory() const;
+
+    // O registrador (indice decodificado) pertence aos bancos configurados?
+    bool register_in_banks(int reg) const {
+        return reg < R_REG_BASE ? reg < f_regs : reg - R_REG_BASE < r_regs;
+    }
+    bool instruction_in_banks(const DecodedInst& code) const {
+        return register_in_banks(code.dest) && register_in_banks(code.src1) &&
+               (code.src2 < 0 || register_in_banks(code.src2));
+    }
+
+private:
+    bool set(const std::string& key, const std::string& value, const std::string& where);
+    bool load_registers(const std::string& filename, const std::string& where);
+};
+
+#endif // CONFIG_H
@@ -0,0 +1,806 @@
+#include "ensemble.h"
+#include "sweep.h"
+#include <thread>
+#include <atomic>
+#include <chrono>
+#include <iomanip>
+#include <cstring>
+
+// --- Vetores de SIMD_WIDTH Entradas (extensoes vetoriais do GCC/Clang) ---
+// Comparacoes entre vetores dao -1 (verdadeiro) ou 0 em cada entrada
+namespace {
+
+typedef char Flag2 __attribute__((vector_size(2)));
+typedef uint8_t Op2 __attribute__((vector_size(2)));
+typedef int32_t Int2 __attribute__((vector_size(8)));
+typedef int64_t Long2 __attribute__((vector_size(16)));
+typedef double Double2 __attribute__((vector_size(16)));
+
+template <class V, class T> inline V load_lanes(const T* p) {
+    V v;
+    std::memcpy(&v, p, sizeof(v));
+    return v;
+}
+template <class V, class T> inline void store_lanes(T* p, V v) {
+    std::memcpy(p, &v, sizeof(v));
+}
+
+}
+
+uint64_t machine_state_hash(const std::vector<double>& registers,
+                            const std::vector<std::pair<long, double>>& cells) {
+    uint64_t h = 14695981039346656037ULL;
+    auto mix = [&h](const void* data, size_t bytes) {
+        const unsigned char* p = static_cast<const unsigned char*>(data);
+        for (size_t i = 0; i < bytes; ++i) {
+            h ^= p[i];
+            h *= 1099511628211ULL;
+        }
+    };
+    mix(registers.data(), registers.size() * sizeof(double));
+    for (auto const& cell : cells) {
+        mix(&cell.first, sizeof(cell.first));
+        mix(&cell.second, sizeof(cell.second));
+    }
+    return h;
+}
+
+
+// --- Estado Escalar de uma Pista ---
+// Tudo que nao fica nas tabelas por pista: posicao no programa, ROB, fila de
+// STOREs, caches, registradores, memoria e contadores
+struct Ensemble::Lane {
+    std::shared_ptr<const Program> program;
+    size_t index = 0;                   // posicao do programa em 'programs' (e em 'results')
+    const DecodedInst* code = nullptr;
+    long size = 0;
+    bool active = false;
+    long cycle = 0;
+    long pc = 0;
+    long committed = 0;
+    bool issue_progress = false;        // o issue emitiu uma instrucao no ciclo atual
+
+    ReorderBuffer rob;
+    StoreQueue store_queue;
+    CacheHierarchy caches;
+    PagedMemory memory;
+    std::vector<double> reg_file;
+    std::vector<Tag> reg_status;
+    std::vector<long> reg_producer;
+    SimStats stats;
+};
+
+bool Ensemble::supports(const SimConfig& config, const std::string& where) {
+    if (config.fast_forward != 0 || config.warmup > 0) {
+        std::cerr << where << ": fast_forward e warmup nao se aplicam a simulacao em conjunto" << std::endl;
+        return false;
+    }
+    return true;
+}
+
+Ensemble::Ensemble(const SimConfig& config, int lanes)
+    : config(config), lanes((std::max(lanes, 1) + SIMD_WIDTH - 1) / SIMD_WIDTH * SIMD_WIDTH), hashing(false),
+      rs_count(config.add_rs + config.mul_rs), ls_count(config.ls_buffers) {
+    for (int op = 0; op <= OP_STORE; ++op) latency[op] = config.mem_latency;
+    latency[OP_ADD] = latency[OP_SUB] = config.add_latency;
+    latency[OP_MUL] = config.mul_latency;
+    latency[OP_DIV] = config.div_latency;
+
+    size_t rs_entries = (size_t)rs_count * this->lanes;
+    size_t ls_entries = (size_t)ls_count * this->lanes;
+    rs.resize((int)rs_entries);
+    ls.resize((int)ls_entries);
+    rs_latency.assign(rs_entries, 0);
+    rs_qj_seq.assign(rs_entries, -1);
+    rs_qk_seq.assign(rs_entries, -1);
+    ls_base_seq.assign(ls_entries, -1);
+    ls_store_seq.assign(ls_entries, -1);
+
+    initial_registers.assign(NUM_REGS, 0.0);
+    for (auto const& reg : config.registers) initial_registers[reg.first] = reg.second;
+    for (auto const& cell : config.initial_memory()) initial_cells.push_back(cell);
+
+    for (int l = 0; l < this->lanes; ++l) {
+        std::unique_ptr<Lane> lane(new Lane());
+        lane->rob.configure(config.rob_size);
+        lane->reg_status.assign(NUM_REGS, NO_TAG);
+        lane->reg_producer.assign(NUM_REGS, -1);
+        lane_state.push_back(std::move(lane));
+    }
+}
+
+Ensemble::~Ensemble() {}
+
+
+// --- Fila de Programas ---
+
+bool Ensemble::run(const std::vector<std::shared_ptr<const Program>>& programs, size_t first, size_t last,
+                   std::vector<EnsembleResult>& results) {
+    size_t next = first;
+    int active = 0;
+    for (int l = 0; l < lanes && next < last; ++l, ++next) {
+        if (!start_lane(l, programs[next], next)) return false;
+        ++active;
+    }
+
+    while (active > 0) {
+        // Mesma ordem de estagios do Simulator (COMMIT -> WB -> EXEC -> ISSUE)
+        for (int l = 0; l < lanes; ++l) {
+            if (!lane_state[l]->active) continue;
+            lane_state[l]->cycle++;
+            commit(l);
+        }
+        for (int l = 0; l < lanes; ++l) {
+            if (lane_state[l]->active) writeback(l);
+        }
+        execute_rs();
+        for (int l = 0; l < lanes; ++l) {
+            if (lane_state[l]->active) execute_ls(l);
+        }
+        for (int l = 0; l < lanes; ++l) {
+            if (lane_state[l]->active) issue(l);
+        }
+
+        // Fim do ciclo: as condicoes de parada do Simulator. Sem saltar ciclos
+        // ociosos os tempos sao os mesmos (o salto do Simulator e exato).
+        for (int l = 0; l < lanes; ++l) {
+            Lane& lane = *lane_state[l];
+            if (!lane.active) continue;
+            lane.stats.rob_occupancy_sum += lane.rob.occupancy();
+            lane.stats.rob_occupancy_max = std::max(lane.stats.rob_occupancy_max, lane.rob.occupancy());
+
+            bool complete = lane.committed == lane.size;
+            bool halted = config.max_cycles > 0 ? lane.cycle > config.max_cycles
+                                                : !complete && config.cycle_skip && stuck(l);
+            if (!complete && !halted) continue;
+
+            finish_lane(l, results[lane.index]);
+            if (next < last) {
+                if (!start_lane(l, programs[next], next)) return false;
+                ++next;
+            } else {
+                --active;
+            }
+        }
+    }
+    return true;
+}
+
+// Poe o programa na pista 'l' com a maquina no estado inicial
+bool Ensemble::start_lane(int l, const std::shared_ptr<const Program>& program, size_t index) {
+    Lane& lane = *lane_state[l];
+    lane.program = program;
+    lane.index = index;
+    lane.code = program->records;
+    lane.size = (long)program->size;
+    lane.active = true;
+    lane.cycle = 0;
+    lane.pc = 0;
+    lane.committed = 0;
+    lane.issue_progress = false;
+    lane.stats = SimStats();
+
+    // ROB ilimitado: as entradas ja alocadas por programas anteriores ficam
+    lane.rob.head = lane.rob.tail = 0;
+    lane.store_queue.clear();
+    lane.caches.configure(config.l1, config.l2, config.mem_latency);
+
+    lane.memory.clear();
+    if (!config.mem_image.empty() && !lane.memory.load_image(config.mem_image, config.mem_base)) return false;
+    for (auto const& cell : initial_cells) lane.memory.write(cell.first, cell.second);
+
+    lane.reg_file = initial_registers;
+    std::fill(lane.reg_status.begin(), lane.reg_status.end(), NO_TAG);
+    std::fill(lane.reg_producer.begin(), lane.reg_producer.end(), -1L);
+    return true;
+}
+
+// Libera as estacoes da pista (um programa parado pelo limite pode deixa-las ocupadas)
+void Ensemble::clear_stations(int l) {
+    for (int slot = 0; slot < rs_count; ++slot) {
+        size_t k = at(slot, l);
+        rs.busy[k] = false;
+        rs.op[k] = OP_NONE;
+        rs.qj[k] = rs.qk[k] = NO_TAG;
+        rs.instruction_id[k] = -1;
+        rs.cycles_remaining[k] = -1;
+        rs.ready_to_writeback[k] = false;
+    }
+    for (int slot = 0; slot < ls_count; ++slot) {
+        size_t k = at(slot, l);
+        ls.busy[k] = false;
+        ls.op[k] = OP_NONE;
+        ls.base_producer[k] = ls.store_producer[k] = NO_TAG;
+        ls.address_ready[k] = false;
+        ls.ready_to_writeback[k] = false;
+        ls.cycles_remaining[k] = -1;
+        ls.instruction_id[k] = -1;
+        ls.store_number[k] = -1;
+    }
+}
+
+void Ensemble::finish_lane(int l, EnsembleResult& result) {
+    Lane& lane = *lane_state[l];
+    lane.stats.cycles = lane.cycle;
+    lane.stats.committed = lane.committed;
+    lane.stats.finished = lane.committed == lane.size;
+    lane.stats.l1 = lane.caches.l1.stats;
+    lane.stats.l2 = lane.caches.l2.stats;
+    result.stats = lane.stats;
+    if (hashing) result.state = machine_state_hash(lane.reg_file, lane.memory.written_cells());
+
+    clear_stations(l);
+    lane.program.reset();
+    lane.active = false;
+}
+
+
+// --- Estagios (regras do Simulator, sem log nem observador) ---
+
+void Ensemble::commit(int l) {
+    Lane& lane = *lane_state[l];
+    int committed_now = 0;
+    while (!lane.rob.empty()) {
+        ROB_Entry& entry = lane.rob.at(lane.rob.head);
+        if (config.commit_width > 0 && committed_now == config.commit_width) {
+            if (entry.ready) lane.stats.commit_width_limited++;
+            break;
+        }
+        if (!entry.ready) break;
+        long seq = lane.rob.head;
+        const DecodedInst& inst = lane.code[seq];
+
+        if (inst.op == OP_STORE) {
+            lane.memory.write(entry.address, entry.value);
+            lane.store_queue.retire();
+        } else if (inst.dest >= 0) {
+            if (lane.reg_producer[inst.dest] == seq) {
+                lane.reg_file[inst.dest] = entry.value;
+                lane.reg_status[inst.dest] = NO_TAG;
+                lane.reg_producer[inst.dest] = -1;
+            }
+            // Dependentes emitidos depois do writeback esperam ate aqui
+            wake(l, entry.producer_tag, seq, entry.value);
+        }
+        lane.rob.retire();
+        lane.committed++;
+        committed_now++;
+    }
+    if (committed_now > 0) lane.stats.commit_active_cycles++;
+}
+
+void Ensemble::writeback(int l) {
+    Lane& lane = *lane_state[l];
+    cdb_candidates.clear();
+    for (int slot = 0; slot < rs_count; ++slot) {
+        size_t k = at(slot, l);
+        if (rs.busy[k] && rs.ready_to_writeback[k]) cdb_candidates.push_back(slot);
+    }
+    for (int slot = 0; slot < ls_count; ++slot) {
+        size_t k = at(slot, l);
+        if (ls.busy[k] && ls.ready_to_writeback[k]) cdb_candidates.push_back(rs_count + slot);
+    }
+    if (config.cdb_arbitration == CDB_OLDEST_FIRST) {
+        auto seq_of = [this, l](int s) {
+            return s < rs_count ? rs.instruction_id[at(s, l)] : ls.instruction_id[at(s - rs_count, l)];
+        };
+        std::sort(cdb_candidates.begin(), cdb_candidates.end(),
+                  [&seq_of](int a, int b) { return seq_of(a) < seq_of(b); });
+    }
+
+    int granted = 0;
+    bool rs_bus = false, ls_bus = false;
+    for (int s : cdb_candidates) {
+        bool is_rs = s < rs_count;
+        if (config.cdb_count == 0) {
+            bool& bus = is_rs ? rs_bus : ls_bus;
+            if (bus) continue;
+            bus = true;
+        } else if (granted == config.cdb_count) {
+            break;
+        }
+        if (is_rs) broadcast_rs(l, s);
+        else broadcast_ls(l, s - rs_count);
+        ++granted;
+    }
+    lane.stats.cdb_broadcasts += granted;
+    lane.stats.cdb_conflicts += (long)cdb_candidates.size() - granted;
+}
+
+void Ensemble::broadcast_rs(int l, int slot) {
+    size_t k = at(slot, l);
+    long seq = rs.instruction_id[k];
+    Tag tag = rs_tag(slot);
+    ROB_Entry& entry = lane_state[l]->rob.at(seq);
+    entry.value = rs.result[k];
+    entry.ready = true;
+    entry.producer_tag = tag;
+    wake(l, tag, seq, rs.result[k]);
+
+    rs.busy[k] = false;
+    rs.ready_to_writeback[k] = false;
+    rs.instruction_id[k] = -1;
+    rs.cycles_remaining[k] = -1;
+}
+
+// LOAD/STORE: so o ROB recebe o valor (os dependentes do LOAD acordam no commit)
+void Ensemble::broadcast_ls(int l, int slot) {
+    size_t k = at(slot, l);
+    ROB_Entry& entry = lane_state[l]->rob.at(ls.instruction_id[k]);
+    entry.value = ls.op[k] == OP_LOAD ? ls.result[k] : ls.store_value[k];
+    entry.ready = true;
+    entry.producer_tag = ls_tag(slot);
+
+    ls.busy[k] = false;
+    ls.op[k] = OP_NONE;
+    ls.base_producer[k] = NO_TAG;
+    ls.store_producer[k] = NO_TAG;
+    ls.address_ready[k] = false;
+    ls.ready_to_writeback[k] = false;
+    ls.cycles_remaining[k] = -1;
+    ls.instruction_id[k] = -1;
+    ls.store_number[k] = -1;
+}
+
+// EXEC das RS de todas as pistas, SIMD_WIDTH entradas por vez (extensoes
+// vetoriais do GCC/Clang). Cada entrada decide por mascara, sem desvio, se
+// inicia, conta a latencia ou conclui; as quatro operacoes sao calculadas
+// sempre (o divisor nulo vira 1 e o quociente e descartado) e o resultado so
+// e gravado onde a execucao terminou. Mesmas regras de Simulator::execute.
+void Ensemble::execute_rs() {
+    size_t n = rs.busy.size();
+    const char* busy = rs.busy.data();
+    const OpCode* op = rs.op.data();
+    const double* vj = rs.vj.data();
+    const double* vk = rs.vk.data();
+    const Tag* qj = rs.qj.data();
+    const Tag* qk = rs.qk.data();
+    const int* op_latency = rs_latency.data();
+    int* remaining = rs.cycles_remaining.data();
+    double* result = rs.result.data();
+    char* done = rs.ready_to_writeback.data();
+
+    for (size_t k = 0; k < n; k += SIMD_WIDTH) {
+        Flag2 done_now = load_lanes<Flag2>(done + k);
+        Long2 ready = (__builtin_convertvector(load_lanes<Flag2>(busy + k), Long2) != 0)
+                    & (__builtin_convertvector(done_now, Long2) == 0)
+                    & (__builtin_convertvector(load_lanes<Int2>(qj + k) | load_lanes<Int2>(qk + k), Long2) == NO_TAG);
+        Long2 before = __builtin_convertvector(load_lanes<Int2>(remaining + k), Long2);
+        Long2 left = before == -1 ? __builtin_convertvector(load_lanes<Int2>(op_latency + k), Long2) : before;
+        left += (left > 0);     // a comparacao vale -1 onde e verdadeira
+        Long2 finished = ready & (left == 0);
+        store_lanes(remaining + k, __builtin_convertvector(ready ? left : before, Int2));
+        store_lanes(done + k, done_now | (__builtin_convertvector(finished, Flag2) & 1));
+
+        Double2 a = load_lanes<Double2>(vj + k), b = load_lanes<Double2>(vk + k);
+        Long2 code = __builtin_convertvector(load_lanes<Op2>(op + k), Long2);
+        Long2 zero = b == 0;
+        Double2 value = zero ? 0.0 : a / (zero ? 1.0 : b);
+        value = code == (int64_t)OP_MUL ? a * b : value;
+        value = code == (int64_t)OP_SUB ? a - b : value;
+        value = code == (int64_t)OP_ADD ? a + b : value;
+        store_lanes(result + k, finished ? value : load_lanes<Double2>(result + k));
+    }
+}
+
+void Ensemble::execute_ls(int l) {
+    Lane& lane = *lane_state[l];
+    for (int slot = 0; slot < ls_count; ++slot) {
+        size_t k = at(slot, l);
+        if (!ls.busy[k] || ls.ready_to_writeback[k]) continue;
+        OpCode op = ls.op[k];
+
+        // Calculo do endereco
+        if (!ls.address_ready[k] && ls.base_producer[k] == NO_TAG) {
+            ls.calculated_address[k] = (long)(ls.base_value[k] + ls.offset[k]);
+            ls.address_ready[k] = true;
+            ls.cycles_remaining[k] = lane.caches.enabled() ? -1 : latency[op];
+            lane.rob.at(ls.instruction_id[k]).address = ls.calculated_address[k];
+            if (op == OP_STORE) lane.store_queue.resolve(ls.store_number[k], ls.calculated_address[k]);
+        }
+        if (!ls.address_ready[k]) continue;
+
+        // Ordem de memoria e valor do STORE
+        if (op == OP_LOAD && load_blocked(l, slot)) continue;
+        if (op == OP_STORE && ls.store_producer[k] != NO_TAG) continue;
+
+        if (ls.cycles_remaining[k] < 0) {
+            int access = lane.caches.access(ls.calculated_address[k], op == OP_STORE, lane.cycle);
+            if (access < 0) continue;
+            ls.cycles_remaining[k] = access;
+        }
+        if (ls.cycles_remaining[k] > 0) ls.cycles_remaining[k]--;
+        if (ls.cycles_remaining[k] != 0) continue;
+
+        if (op == OP_LOAD) {
+            long store = forwarding_store(l, slot);
+            if (store >= 0) {
+                ls.result[k] = store_data(l, store);
+                lane.stats.loads_forwarded++;
+            } else {
+                ls.result[k] = lane.memory.read(ls.calculated_address[k]);
+            }
+        }
+        ls.ready_to_writeback[k] = true;
+    }
+}
+
+void Ensemble::issue(int l) {
+    Lane& lane = *lane_state[l];
+    int issued = 0;
+    while (issued < config.issue_width && issue_one(l)) ++issued;
+    lane.issue_progress = (issued > 0);
+    lane.stats.issued += issued;
+    if (issued == config.issue_width) lane.stats.issue_width_full++;
+}
+
+bool Ensemble::issue_one(int l) {
+    Lane& lane = *lane_state[l];
+    if (lane.pc == lane.size) return false;
+    if (lane.rob.full()) {
+        lane.stats.stall_rob++;
+        return false;
+    }
+    const DecodedInst& inst = lane.code[lane.pc];
+    long seq = lane.pc;
+
+    if (inst.fu != FU_LS) {
+        int first = (inst.fu == FU_ADD) ? 0 : config.add_rs;
+        int last = (inst.fu == FU_ADD) ? config.add_rs : rs_count;
+        int slot = first;
+        while (slot < last && rs.busy[at(slot, l)]) ++slot;
+        if (slot == last) {
+            if (inst.fu == FU_ADD) lane.stats.stall_rs_add++;
+            else lane.stats.stall_rs_mul++;
+            return false;
+        }
+
+        size_t k = at(slot, l);
+        Tag tag = rs_tag(slot);
+        rs.busy[k] = true;
+        rs.op[k] = inst.op;
+        rs.instruction_id[k] = seq;
+        rs.cycles_remaining[k] = -1;
+        rs.ready_to_writeback[k] = false;
+        rs_latency[k] = latency[inst.op];
+        rename_source(lane, inst.src1, rs.vj[k], rs.qj[k], rs_qj_seq[k]);
+        rename_source(lane, inst.src2, rs.vk[k], rs.qk[k], rs_qk_seq[k]);
+        lane.reg_status[inst.dest] = tag;
+        lane.reg_producer[inst.dest] = seq;
+    } else {
+        int slot = 0;
+        while (slot < ls_count && ls.busy[at(slot, l)]) ++slot;
+        if (slot == ls_count) {
+            lane.stats.stall_ls++;
+            return false;
+        }
+
+        size_t k = at(slot, l);
+        Tag tag = ls_tag(slot);
+        ls.busy[k] = true;
+        ls.op[k] = inst.op;
+        ls.dest_reg[k] = inst.dest;
+        ls.offset[k] = inst.offset;
+        ls.instruction_id[k] = seq;
+        ls.cycles_remaining[k] = -1;
+        ls.address_ready[k] = false;
+        ls.ready_to_writeback[k] = false;
+        ls.store_value[k] = 0.0;
+        ls.store_producer[k] = NO_TAG;
+        ls.store_number[k] = (inst.op == OP_STORE) ? lane.store_queue.push(seq, slot) : -1;
+        rename_source(lane, inst.src1, ls.base_value[k], ls.base_producer[k], ls_base_seq[k]);
+        if (inst.op == OP_STORE) {
+            rename_source(lane, inst.dest, ls.store_value[k], ls.store_producer[k], ls_store_seq[k]);
+        } else {
+            lane.reg_status[inst.dest] = tag;
+            lane.reg_producer[inst.dest] = seq;
+        }
+    }
+    lane.rob.allocate();
+    lane.pc++;
+    return true;
+}
+
+// Nenhum evento futuro na pista (o Simulator para como travado)? Mesmo teste
+// de Simulator::skip_idle_cycles quando nao ha proximo evento
+bool Ensemble::stuck(int l) {
+    Lane& lane = *lane_state[l];
+    if (lane.issue_progress) return false;
+    if (!lane.rob.empty() && lane.rob.at(lane.rob.head).ready) return false;
+    for (int slot = 0; slot < rs_count; ++slot) {
+        size_t k = at(slot, l);
+        if (!rs.busy[k]) continue;
+        if (rs.ready_to_writeback[k] || (rs.qj[k] == NO_TAG && rs.qk[k] == NO_TAG)) return false;
+    }
+    for (int slot = 0; slot < ls_count; ++slot) {
+        size_t k = at(slot, l);
+        if (!ls.busy[k]) continue;
+        if (ls.ready_to_writeback[k]) return false;
+        if (!ls.address_ready[k]) {
+            if (ls.base_producer[k] == NO_TAG) return false;
+            continue;
+        }
+        if (ls.op[k] == OP_LOAD && load_blocked(l, slot)) continue;
+        if (ls.op[k] == OP_STORE && ls.store_producer[k] != NO_TAG) continue;
+        return false;
+    }
+    return true;
+}
+
+
+// --- Renomeacao e CDB ---
+
+void Ensemble::rename_source(Lane& lane, int reg, double& value, Tag& producer, long& producer_seq) {
+    if (lane.reg_status[reg] == NO_TAG) {
+        value = lane.reg_file[reg];
+        producer = NO_TAG;
+    } else {
+        producer = lane.reg_status[reg];
+        producer_seq = lane.reg_producer[reg];
+    }
+}
+
+// Entrega 'value' aos operandos da pista que esperam a instrucao
+// 'producer_seq' na estacao 'tag' (as estacoes de uma pista sao poucas: a
+// busca direta substitui as listas de espera do Simulator)
+void Ensemble::wake(int l, Tag tag, long producer_seq, double value) {
+    for (int slot = 0; slot < rs_count; ++slot) {
+        size_t k = at(slot, l);
+        if (!rs.busy[k]) continue;
+        if (rs.qj[k] == tag && rs_qj_seq[k] == producer_seq) { rs.vj[k] = value; rs.qj[k] = NO_TAG; }
+        if (rs.qk[k] == tag && rs_qk_seq[k] == producer_seq) { rs.vk[k] = value; rs.qk[k] = NO_TAG; }
+    }
+    for (int slot = 0; slot < ls_count; ++slot) {
+        size_t k = at(slot, l);
+        if (!ls.busy[k]) continue;
+        if (ls.base_producer[k] == tag && ls_base_seq[k] == producer_seq) {
+            ls.base_value[k] = value;
+            ls.base_producer[k] = NO_TAG;
+        }
+        if (ls.store_producer[k] == tag && ls_store_seq[k] == producer_seq) {
+            ls.store_value[k] = value;
+            ls.store_producer[k] = NO_TAG;
+        }
+    }
+}
+
+// --- Ordem de Memoria (como no Simulator, com a StoreQueue da pista) ---
+
+long Ensemble::forwarding_store(int l, int slot) {
+    size_t k = at(slot, l);
+    return lane_state[l]->store_queue.youngest_before(ls.calculated_address[k], ls.instruction_id[k]);
+}
+
+double Ensemble::store_data(int l, long number) {
+    Lane& lane = *lane_state[l];
+    const ROB_Entry& entry = lane.rob.at(lane.store_queue.seq(number));
+    return entry.ready ? entry.value : ls.store_value[at(lane.store_queue.slot(number), l)];
+}
+
+bool Ensemble::load_blocked(int l, int slot) {
+    Lane& lane = *lane_state[l];
+    if (lane.store_queue.unresolved_before(ls.instruction_id[at(slot, l)])) return true;
+    long store = forwarding_store(l, slot);
+    if (store < 0) return false;
+    if (!config.store_forwarding) return true;
+    return !lane.rob.at(lane.store_queue.seq(store)).ready &&
+           ls.store_producer[at(lane.store_queue.slot(store), l)] != NO_TAG;
+}
+
+
+// --- Subcomando "ensemble" ---
+
+namespace {
+
+std::string csv_field(const std::string& s) {
+    if (s.find_first_of(",\"\n") == std::string::npos) return s;
+    std::string out = "\"";
+    for (char c : s) {
+        if (c == '"') out += '"';
+        out += c;
+    }
+    return out + "\"";
+}
+
+// Contadores que o motor em conjunto produz, comparados com o Simulator em --check
+bool same_stats(const SimStats& a, const SimStats& b) {
+    return a.cycles == b.cycles && a.committed == b.committed && a.finished == b.finished
+        && a.stall_rs_add == b.stall_rs_add && a.stall_rs_mul == b.stall_rs_mul && a.stall_ls == b.stall_ls
+        && a.stall_rob == b.stall_rob && a.stall_window == b.stall_window
+        && a.rob_occupancy_sum == b.rob_occupancy_sum && a.rob_occupancy_max == b.rob_occupancy_max
+        && a.commit_width_limited == b.commit_width_limited && a.commit_active_cycles == b.commit_active_cycles
+        && a.cdb_conflicts == b.cdb_conflicts && a.cdb_broadcasts == b.cdb_broadcasts
+        && a.loads_forwarded == b.loads_forwarded && a.issued == b.issued && a.issue_width_full == b.issue_width_full
+        && a.l1.hits == b.l1.hits && a.l1.misses == b.l1.misses && a.l1.mshr_merges == b.l1.mshr_merges
+        && a.l2.hits == b.l2.hits && a.l2.misses == b.l2.misses && a.l2.mshr_merges == b.l2.mshr_merges;
+}
+
+bool read_list(const std::string& filename, std::vector<std::string>& traces) {
+    std::ifstream file(filename);
+    if (!file) {
+        std::cerr << "Erro ao abrir a lista de traces: " << filename << std::endl;
+        return false;
+    }
+    std::string line;
+    while (std::getline(file, line)) {
+        if (!line.empty() && line.back() == '\r') line.pop_back();
+        if (!line.empty() && line[0] != '#') traces.push_back(line);
+    }
+    return true;
+}
+
+void print_ensemble_usage() {
+    std::cerr << "Uso: simulador ensemble [opcoes] <trace> [<trace> ...]" << std::endl;
+    std::cerr << "  --list ARQ           traces a simular, um por linha (alem dos argumentos)" << std::endl;
+    std::cerr << "  --lanes N            programas simulados juntos por thread (padrao 16)" << std::endl;
+    std::cerr << "  --threads N          numero de threads (padrao: todos os nucleos)" << std::endl;
+    std::cerr << "  --config ARQ         configuracao da maquina (arquivo chave = valor)" << std::endl;
+    std::cerr << "  --set CHAVE=VALOR    sobrescreve uma chave da configuracao (pode repetir)" << std::endl;
+    std::cerr << "  --out ARQ            arquivo CSV de saida (padrao: saida padrao)" << std::endl;
+    std::cerr << "  --state              coluna 'state': hash dos registradores e da memoria finais" << std::endl;
+    std::cerr << "  --check              simula cada trace tambem no Simulator e compara os resultados" << std::endl;
+    std::cerr << "Ex: simulador ensemble --list kernels.txt --set max_cycles=0 --state --out res.csv" << std::endl;
+}
+
+}
+
+int run_ensemble(int argc, char* argv[]) {
+    std::vector<std::string> traces;
+    std::vector<std::string> overrides;
+    const char* config_file = nullptr;
+    std::string out_file;
+    int lanes = 16;
+    int threads = (int)std::thread::hardware_concurrency();
+    bool with_state = false;
+    bool check = false;
+
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        bool takes_value = arg == "--list" || arg == "--lanes" || arg == "--threads" || arg == "--config"
+                        || arg == "--set" || arg == "--out";
+        if (takes_value) {
+            if (i + 1 >= argc) {
+                std::cerr << "Opcao " << arg << " exige um valor" << std::endl;
+                return EXIT_FAILURE;
+            }
+            std::string value = argv[++i];
+            if (arg == "--list") {
+                if (!read_list(value, traces)) return EXIT_FAILURE;
+            } else if (arg == "--config") config_file = argv[i];
+            else if (arg == "--set") overrides.push_back(value);
+            else if (arg == "--out") out_file = value;
+            else {
+                int n = std::atoi(value.c_str());
+                if (n < 1 || (arg == "--lanes" && n > 4096)) {
+                    std::cerr << "Valor invalido para " << arg << ": " << value << std::endl;
+                    return EXIT_FAILURE;
+                }
+                if (arg == "--lanes") lanes = n;
+                else threads = n;
+            }
+        } else if (arg == "--state") {
+            with_state = true;
+        } else if (arg == "--check") {
+            check = true;
+        } else if (arg == "--help") {
+            print_ensemble_usage();
+            return EXIT_SUCCESS;
+        } else if (!arg.empty() && arg[0] == '-') {
+            std::cerr << "Opcao desconhecida: " << arg << std::endl;
+            print_ensemble_usage();
+            return EXIT_FAILURE;
+        } else {
+            traces.push_back(arg);
+        }
+    }
+    if (traces.empty()) {
+        print_ensemble_usage();
+        return EXIT_FAILURE;
+    }
+
+    SimConfig config;
+    if (config_file != nullptr && !config.load_file(config_file)) return EXIT_FAILURE;
+    for (const std::string& assignment : overrides) {
+        if (!config.apply(assignment, "linha de comando")) return EXIT_FAILURE;
+    }
+    if (!config.validate("configuracao") || !Ensemble::supports(config, "configuracao")) return EXIT_FAILURE;
+
+    WorkStealingPool pool(threads);
+    auto start = std::chrono::steady_clock::now();
+
+    std::vector<std::shared_ptr<const Program>> programs(traces.size());
+    std::atomic<bool> failed(false);
+    pool.run(traces.size(), [&](size_t t) {
+        std::shared_ptr<Program> program(new Program());
+        if (!load_program(traces[t], *program) ||
+            !Simulator::fits_register_banks(config, program->f_regs, program->r_regs, traces[t])) {
+            failed = true;
+        }
+        programs[t] = program;
+    });
+    if (failed) return EXIT_FAILURE;
+
+    // Blocos de programas consecutivos; cada bloco passa por um Ensemble com
+    // 'lanes' pistas. Alguns blocos por thread, mas nunca menos programas que pistas
+    size_t per_thread = (traces.size() + pool.size() * 4 - 1) / (pool.size() * 4);
+    size_t block = std::max<size_t>(lanes, std::min<size_t>((size_t)lanes * 64, per_thread));
+    size_t blocks = (traces.size() + block - 1) / block;
+    std::vector<EnsembleResult> results(traces.size());
+    pool.run(blocks, [&](size_t b) {
+        Ensemble ensemble(config, lanes);
+        ensemble.hash_state(with_state || check);
+        size_t first = b * block;
+        if (!ensemble.run(programs, first, std::min(first + block, traces.size()), results)) failed = true;
+    });
+    if (failed) return EXIT_FAILURE;
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    // --- Conferencia com o Simulator ---
+    if (check) {
+        std::atomic<long> mismatches(0);
+        pool.run(traces.size(), [&](size_t t) {
+            Simulator sim(config, MODE_SILENT);
+            if (!sim.init_memory()) {
+                failed = true;
+                return;
+            }
+            if (!sim.open_program(programs[t])) {
+                failed = true;
+                return;
+            }
+            sim.run();
+            std::vector<double> registers(NUM_REGS);
+            for (int r = 0; r < NUM_REGS; ++r) registers[r] = sim.register_value(r);
+            uint64_t state = machine_state_hash(registers, sim.written_memory());
+            if (!same_stats(sim.get_stats(), results[t].stats) || state != results[t].state) {
+                if (mismatches++ < 10) std::cerr << "Resultado diferente do Simulator: " << traces[t] << std::endl;
+            }
+        });
+        if (failed) return EXIT_FAILURE;
+        if (mismatches > 0) {
+            std::cerr << mismatches << " de " << traces.size() << " traces com resultado diferente do Simulator" << std::endl;
+            return EXIT_FAILURE;
+        }
+        std::cerr << "Conferencia: " << traces.size() << " traces identicos ao Simulator" << std::endl;
+    }
+
+    // --- Tabela de Resultados (colunas da varredura) ---
+    std::ofstream file;
+    if (!out_file.empty()) {
+        file.open(out_file);
+        if (!file) {
+            std::cerr << "Erro ao criar arquivo de saida: " << out_file << std::endl;
+            return EXIT_FAILURE;
+        }
+    }
+    std::ostream& out = out_file.empty() ? std::cout : file;
+
+    const char* counters[] = {"stall_rs_add", "stall_rs_mul", "stall_ls", "stall_rob",
+                              "stall_window", "commit_width_limited", "issue_width_full", "cdb_conflicts",
+                              "l1_hits", "l1_misses", "l2_hits", "l2_misses"};
+    out << "trace,instructions,committed,cycles,ipc,finished";
+    for (const char* name : counters) out << "," << name;
+    if (with_state) out << ",state";
+    out << "\n";
+
+    long instructions = 0;
+    out << std::fixed << std::setprecision(4);
+    for (size_t t = 0; t < traces.size(); ++t) {
+        const SimStats& r = results[t].stats;
+        long values[] = {r.stall_rs_add, r.stall_rs_mul, r.stall_ls, r.stall_rob,
+                         r.stall_window, r.commit_width_limited, r.issue_width_full, r.cdb_conflicts,
+                         r.l1.hits, r.l1.misses, r.l2.hits, r.l2.misses};
+        out << csv_field(traces[t]) << "," << programs[t]->size << "," << r.committed << "," << r.cycles
+            << "," << r.ipc() << "," << (r.finished ? 1 : 0);
+        for (long v : values) out << "," << v;
+        if (with_state) out << "," << std::hex << std::setw(16) << std::setfill('0') << results[t].state
+                            << std::dec << std::setfill(' ');
+        out << "\n";
+        instructions += r.committed;
+    }
+
+    std::cerr << traces.size() << " traces em " << std::setprecision(2) << seconds << " s com "
+              << std::min<size_t>(pool.size(), std::max<size_t>(blocks, 1)) << " threads e " << lanes << " pistas ("
+              << (seconds > 0 ? instructions / seconds / 1e6 : 0.0) << " M instrucoes/s)" << std::endl;
+    return EXIT_SUCCESS;
+}
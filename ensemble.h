@@ -0,0 +1,109 @@
+#ifndef ENSEMBLE_H
+#define ENSEMBLE_H
+
+#include "simulator.h"
+
+// Resultado de um programa simulado em conjunto
+struct EnsembleResult {
+    // Mesmos valores do Simulator, exceto a pilha de CPI e os contadores por
+    // estacao, que o motor em conjunto nao coleta
+    SimStats stats;
+    uint64_t state = 0;     // hash dos registradores e da memoria finais (ver machine_state_hash)
+};
+
+// Hash FNV-1a do banco de registradores e das celulas de memoria escritas:
+// dois programas terminam no mesmo estado se e so se (salvo colisao) o hash e igual
+uint64_t machine_state_hash(const std::vector<double>& registers,
+                            const std::vector<std::pair<long, double>>& cells);
+
+// --- Simulacao em Conjunto ---
+// Muitos programas pequenos e independentes, todos na mesma maquina, sao
+// simulados juntos, um por pista, avancando um ciclo por vez em todas as
+// pistas. As estacoes de reserva ficam em layout por pista: o campo da
+// estacao 'slot' na pista 'lane' esta em [slot * lanes + lane], de modo que o
+// EXEC das RS (operandos prontos, contagem da latencia e calculo do
+// resultado) e um unico laco vetorial, sem desvios, sobre todas as pistas. O resto (issue, writeback, commit, L/S, ROB, caches,
+// memoria) e escalar por pista, com as mesmas regras do Simulator.
+// Quando um programa termina, a pista recebe o proximo da fila, entao
+// programas de tamanhos diferentes nao deixam pistas ociosas.
+class Ensemble {
+public:
+    // Entradas por vetor no EXEC das RS; o numero de pistas e arredondado
+    // para um multiplo dele
+    static const int SIMD_WIDTH = 2;
+
+    // A configuracao cabe no motor em conjunto? (sem fast_forward e warmup;
+    // log, checkpoints e observadores nao existem aqui). Erros em std::cerr.
+    static bool supports(const SimConfig& config, const std::string& where);
+
+    Ensemble(const SimConfig& config, int lanes);
+    ~Ensemble();
+
+    // Calcula EnsembleResult::state de cada programa
+    void hash_state(bool on) { hashing = on; }
+
+    // Simula programs[first, last); o resultado do programa i vai para results[i].
+    // Retorna false se a memoria inicial nao pode ser montada.
+    bool run(const std::vector<std::shared_ptr<const Program>>& programs, size_t first, size_t last,
+             std::vector<EnsembleResult>& results);
+
+private:
+    struct Lane;
+
+    SimConfig config;
+    int lanes;
+    bool hashing;
+    int latency[OP_STORE + 1];      // latencia por operacao
+    std::vector<double> initial_registers;
+    std::vector<std::pair<long, double>> initial_cells;
+
+    // Estacoes de todas as pistas, indexadas por slot * lanes + pista. As
+    // tabelas do Simulator com mais campos: latencia da operacao da RS e a
+    // sequencia do produtor de cada operando, que separa as esperas por
+    // produtores diferentes na mesma estacao (o papel das listas de espera)
+    RS_Table rs;
+    LS_Table ls;
+    int rs_count;
+    int ls_count;
+    std::vector<int> rs_latency;
+    std::vector<long> rs_qj_seq;
+    std::vector<long> rs_qk_seq;
+    std::vector<long> ls_base_seq;
+    std::vector<long> ls_store_seq;
+
+    std::vector<std::unique_ptr<Lane>> lane_state;
+    std::vector<int> cdb_candidates;
+
+    size_t at(int slot, int lane) const { return (size_t)slot * lanes + lane; }
+    Tag rs_tag(int slot) const { return slot + 1; }
+    Tag ls_tag(int slot) const { return rs_count + slot + 1; }
+
+    bool start_lane(int l, const std::shared_ptr<const Program>& program, size_t index);
+    void clear_stations(int l);
+    void finish_lane(int l, EnsembleResult& result);
+    void commit(int l);
+    void writeback(int l);
+    void broadcast_rs(int l, int slot);
+    void broadcast_ls(int l, int slot);
+    void execute_rs();
+    void execute_ls(int l);
+    void issue(int l);
+    bool issue_one(int l);
+    bool stuck(int l);
+    void rename_source(Lane& lane, int reg, double& value, Tag& producer, long& producer_seq);
+    void wake(int l, Tag tag, long producer_seq, double value);
+    bool load_blocked(int l, int slot);
+    long forwarding_store(int l, int slot);
+    double store_data(int l, long number);
+
+    Ensemble(const Ensemble&) = delete;
+    Ensemble& operator=(const Ensemble&) = delete;
+};
+
+// --- Subcomando "ensemble" ---
+// Le muitos traces pequenos (argumentos ou --list), simula todos em conjunto
+// distribuidos entre threads e grava uma linha CSV por trace, com as mesmas
+// colunas da varredura. argv[0] e o proprio "ensemble".
+int run_ensemble(int argc, char* argv[]);
+
+#endif // ENSEMBLE_H
@@ -0,0 +1,234 @@
+#include "eventlog.h"
+#include "trace.h"
+#include <iostream>
+#include <sstream>
+#include <iomanip>
+#include <chrono>
+#include <cstring>
+
+// Eventos no anel (potencia de 2): ~3.5 MB, alocados so quando o log e aberto
+static const uint64_t RING_EVENTS = 1 << 16;
+
+// --- Formatacao ---
+
+std::string station_name(int tag, int add_rs, int rs_count) {
+    if (tag == 0) return "";
+    int index = tag - 1;
+    if (index < add_rs) return "Add" + std::to_string(index + 1);
+    if (index < rs_count) return "Mult" + std::to_string(index - add_rs + 1);
+    return "L/S" + std::to_string(index - rs_count + 1);
+}
+
+static std::string register_name(int index) {
+    if (index >= R_REG_BASE) return "R" + std::to_string(index - R_REG_BASE);
+    return "F" + std::to_string(index);
+}
+
+std::string render_event(const LogEvent& e, const EventLogHeader& header) {
+    std::ostringstream out;
+    out << std::fixed << std::setprecision(4);
+    int rs_count = header.add_rs + header.mul_rs;
+    std::string tag = station_name(e.station, header.add_rs, rs_count);
+    const char* op = op_name((OpCode)e.op);
+
+    switch ((EventKind)e.kind) {
+        case EV_CYCLE:
+            out << "\n--- CICLO " << e.cycle << " ---";
+            break;
+        case EV_SKIP:
+            out << "\n--- CICLOS " << e.cycle << " a " << e.a << ": pulados (apenas as latencias avancam) ---";
+            break;
+        case EV_SUMMARY:
+            out << "Ciclo " << e.cycle << ": commits " << e.b << " | emitidas " << e.c
+                << " | CDB " << e.d << " | ROB " << e.a;
+            break;
+
+        case EV_COMMIT_STORE:
+            out << "  [COMMIT] STORE ID" << e.a << " mem[" << e.b << "] = " << e.value;
+            break;
+        case EV_COMMIT_WRITE:
+            out << "  [COMMIT] WRITE " << register_name(e.reg[0]) << " = " << e.value << " (ID" << e.a << ")";
+            break;
+        case EV_COMMIT_SKIP_WRITE:
+            out << "  [COMMIT] Skipped write to " << register_name(e.reg[0]) << " because reg_status changed.";
+            break;
+
+        case EV_ISSUE_DONE:
+            out << "  [ISSUE] Todas as instrucoes ja foram emitidas.";
+            break;
+        case EV_ISSUE_WINDOW_FULL:
+            out << "  [ISSUE] Parado: janela de instrucoes cheia";
+            break;
+        case EV_ISSUE_ROB_FULL:
+            out << "  [ISSUE] Parado: ROB cheio (" << e.a << " entradas)";
+            break;
+        case EV_ISSUE_NO_RS:
+            out << "  [ISSUE] Parado: Perigo Estrutural em " << op << " (Sem RS Livre)";
+            break;
+        case EV_ISSUE_NO_LS:
+            out << "  [ISSUE] Parado: Perigo Estrutural em " << op << " (Sem L/S Buffer Livre)";
+            break;
+        case EV_ISSUE:
+        case EV_ISSUE_LS:
+            out << "  [ISSUE] Emitindo (" << e.a << "/" << (e.b >= 0 ? std::to_string(e.b) : "?") << ") " << op << " "
+                << register_name(e.reg[0]);
+            if (e.kind == EV_ISSUE) out << "," << register_name(e.reg[1]) << "," << register_name(e.reg[2]);
+            else out << ", " << e.d << "(" << register_name(e.reg[1]) << ")";
+            out << " para " << tag;
+            break;
+
+        case EV_EXEC_START:
+            out << "  [EXEC] Iniciando " << tag << " (" << op << ") | Latencia: " << e.d;
+            break;
+        case EV_EXEC_DONE:
+            out << "  [EXEC] Concluindo " << tag << " | Resultado: " << e.value;
+            break;
+        case EV_EXEC_ADDRESS:
+            out << "  [EXEC] Endereco de " << tag << " (" << op << ") calculado: " << e.a;
+            break;
+        case EV_EXEC_MEM_HAZARD:
+            out << "  [EXEC] " << tag << " (LOAD) PARADO: Perigo de Memoria com STORE mais antigo";
+            break;
+        case EV_EXEC_STORE_WAIT:
+            out << "  [EXEC] " << tag << " (STORE) PARADO: Esperando valor do produtor "
+                << station_name(e.d, header.add_rs, rs_count);
+            break;
+        case EV_EXEC_NO_MSHR:
+            out << "  [EXEC] " << tag << " (" << op << ") PARADO: sem MSHR livre no cache";
+            break;
+        case EV_EXEC_CACHE:
+            out << "  [EXEC] " << tag << " (" << op << ") acessa o cache: " << e.d << " ciclo(s)";
+            break;
+        case EV_EXEC_FORWARD:
+            out << "  [EXEC] Concluindo " << tag << " (LOAD). Valor encaminhado do STORE ID" << e.a << ": " << e.value;
+            break;
+        case EV_EXEC_LOAD:
+            out << "  [EXEC] Concluindo " << tag << " (LOAD). Valor lido: " << e.value;
+            break;
+        case EV_EXEC_STORE:
+            out << "  [EXEC] Concluindo " << tag << " (STORE). Pronto para escrever na memoria.";
+            break;
+        case EV_EXEC_IDLE:
+            out << "  [EXEC] Nenhuma RS/LS iniciou ou avancou a execucao.";
+            break;
+
+        case EV_WB_BROADCAST:
+            out << "  [WB] " << tag << " transmitiu resultado " << e.value << " (aguardando commit)";
+            break;
+        case EV_WB_LOAD:
+            out << "  [WB] " << tag << " (LOAD) leu valor " << e.value << " e liberou buffer";
+            break;
+        case EV_WB_STORE:
+            out << "  [WB] " << tag << " (STORE) pronto para commit";
+            break;
+
+        default:
+            out << "  [?] evento desconhecido (tipo " << (int)e.kind << ")";
+            break;
+    }
+    return out.str();
+}
+
+
+// --- Buffer Circular ---
+
+EventLog::EventLog()
+    : mask(0), head(0), tail(0), seen_head(0),
+      closing(false), failed(false), file(nullptr), to_screen(false), header() {}
+
+EventLog::~EventLog() {
+    close();
+}
+
+bool EventLog::open_file(const std::string& filename, const EventLogHeader& log_header) {
+    name = filename;
+    header = log_header;
+    memcpy(header.magic, EVENT_LOG_MAGIC, 8);
+    header.version = EVENT_LOG_VERSION;
+    header.record_size = sizeof(LogEvent);
+    ring.assign(RING_EVENTS, LogEvent());
+    mask = RING_EVENTS - 1;
+
+    file = std::fopen(filename.c_str(), "wb");
+    if (file == nullptr) {
+        std::cerr << "Erro ao criar log de eventos: " << filename << std::endl;
+        return false;
+    }
+    if (std::fwrite(&header, sizeof(header), 1, file) != 1) failed = true;
+    writer = std::thread(&EventLog::writer_loop, this);
+    return true;
+}
+
+void EventLog::open_screen(const EventLogHeader& log_header) {
+    header = log_header;
+    ring.assign(RING_EVENTS, LogEvent());
+    mask = RING_EVENTS - 1;
+    to_screen = true;
+}
+
+// Grava tudo o que o simulador ja publicou, em blocos contiguos do anel
+void EventLog::drain_file() {
+    uint64_t t = tail.load(std::memory_order_acquire);
+    uint64_t h = head.load(std::memory_order_relaxed);
+    while (h < t) {
+        uint64_t start = h & mask;
+        uint64_t n = std::min(t - h, ring.size() - start);
+        if (!failed && std::fwrite(&ring[start], sizeof(LogEvent), n, file) != n) failed = true;
+        h += n;
+        head.store(h, std::memory_order_release);
+    }
+}
+
+void EventLog::writer_loop() {
+    for (;;) {
+        // 'closing' lido antes de drenar: tudo o que veio antes de close() e gravado
+        bool stop = closing.load(std::memory_order_acquire);
+        uint64_t before = head.load(std::memory_order_relaxed);
+        drain_file();
+        if (stop) break;
+        if (head.load(std::memory_order_relaxed) == before) {
+            std::this_thread::sleep_for(std::chrono::microseconds(200));
+        }
+    }
+}
+
+void EventLog::wait_for_space() {
+    if (to_screen) {
+        head.store(tail.load(std::memory_order_relaxed) - ring.size() / 2, std::memory_order_relaxed);
+        seen_head = head.load(std::memory_order_relaxed);
+        return;
+    }
+    for (;;) {
+        seen_head = head.load(std::memory_order_acquire);
+        if (tail.load(std::memory_order_relaxed) - seen_head < ring.size()) return;
+        std::this_thread::yield();
+    }
+}
+
+void EventLog::render_pending(std::vector<std::string>& lines) {
+    uint64_t t = tail.load(std::memory_order_relaxed);
+    for (uint64_t h = head.load(std::memory_order_relaxed); h < t; ++h) {
+        lines.push_back(render_event(ring[h & mask], header));
+    }
+    discard_pending();
+}
+
+void EventLog::discard_pending() {
+    seen_head = tail.load(std::memory_order_relaxed);
+    head.store(seen_head, std::memory_order_relaxed);
+}
+
+bool EventLog::close() {
+    to_screen = false;
+    if (file == nullptr) return true;
+
+    closing.store(true, std::memory_order_release);
+    writer.join();
+    if (std::fclose(file) != 0) failed = true;
+    file = nullptr;
+    if (failed) {
+        std::cerr << "Erro ao gravar log de eventos: " << name << std::endl;
+        return false;
+    }
+    return true;
+}
@@ -0,0 +1,150 @@
+#ifndef EVENTLOG_H
+#define EVENTLOG_H
+
+#include <string>
+#include <vector>
+#include <atomic>
+#include <thread>
+#include <cstdio>
+#include <cstdint>
+
+// --- Nivel do Log de Eventos ---
+enum LogLevel : uint8_t {
+    LOG_OFF,        // nada e registrado
+    LOG_SUMMARY,    // um registro por ciclo (commits, emissoes, CDB, ROB)
+    LOG_EVENTS      // cada evento dos estagios, como no modo interativo
+};
+
+// --- Tipos de Evento ---
+// Campos usados por cada tipo (os demais ficam em zero). 'station' e a tag
+// da estacao (ver Tag em simulator.h); 'reg' guarda registradores decodificados.
+enum EventKind : uint8_t {
+    EV_CYCLE,               // inicio do ciclo
+    EV_SKIP,                // ciclos pulados: cycle = primeiro, a = ultimo
+    EV_SUMMARY,             // a = ocupacao do ROB, b = commits, c = emitidas, d = resultados no CDB
+
+    EV_COMMIT_STORE,        // a = id, b = endereco, value
+    EV_COMMIT_WRITE,        // a = id, reg[0] = destino, value
+    EV_COMMIT_SKIP_WRITE,   // reg[0] = destino (renomeado por instrucao mais nova)
+
+    EV_ISSUE_DONE,          // todas as instrucoes emitidas
+    EV_ISSUE_WINDOW_FULL,
+    EV_ISSUE_ROB_FULL,      // a = ocupacao do ROB
+    EV_ISSUE_NO_RS,         // op
+    EV_ISSUE_NO_LS,         // op
+    EV_ISSUE,               // a = posicao (1..), b = total (-1 = desconhecido), station, op, reg = dest, src1, src2
+    EV_ISSUE_LS,            // idem, com d = deslocamento e reg = dest, base
+
+    EV_EXEC_START,          // station, op, d = latencia
+    EV_EXEC_DONE,           // station, value
+    EV_EXEC_ADDRESS,        // station, op, a = endereco
+    EV_EXEC_MEM_HAZARD,     // station (LOAD esperando STORE mais antigo)
+    EV_EXEC_STORE_WAIT,     // station, d = tag do produtor do valor
+    EV_EXEC_NO_MSHR,        // station, op
+    EV_EXEC_CACHE,          // station, op, d = latencia do acesso
+    EV_EXEC_FORWARD,        // station, a = id do STORE, value
+    EV_EXEC_LOAD,           // station, value
+    EV_EXEC_STORE,          // station
+    EV_EXEC_IDLE,           // nenhuma estacao iniciou ou avancou
+
+    EV_WB_BROADCAST,        // station, value
+    EV_WB_LOAD,             // station, value
+    EV_WB_STORE,            // station
+
+    EV_KIND_COUNT
+};
+
+// Registro de tamanho fixo (56 bytes), gravado como esta na ordem nativa
+struct LogEvent {
+    int64_t cycle;
+    int64_t a;
+    int64_t b;
+    double value;
+    int32_t station;
+    int32_t c;
+    int32_t d;
+    int16_t reg[3];
+    uint8_t kind;       // EventKind
+    uint8_t op;         // OpCode
+    uint32_t reserved;
+};
+
+// --- Arquivo de Log ---
+// Cabecalho seguido dos registros. As quantidades de estacoes permitem
+// nomear as tags ("Add1", "Mult2", "L/S1") na hora de renderizar.
+#define EVENT_LOG_MAGIC "TOMAELOG"
+#define EVENT_LOG_VERSION 1
+
+struct EventLogHeader {
+    char magic[8];
+    uint32_t version;
+    uint32_t record_size;   // sizeof(LogEvent) de quem gravou
+    int32_t add_rs;
+    int32_t mul_rs;
+    int32_t ls_buffers;
+    uint8_t level;
+    uint8_t reserved[3];
+};
+
+// Nome de exibicao de uma tag de estacao ("" = sem produtor)
+std::string station_name(int tag, int add_rs, int rs_count);
+
+// Texto de um evento, no formato do modo interativo (sem a quebra de linha final)
+std::string render_event(const LogEvent& event, const EventLogHeader& header);
+
+// --- Buffer Circular de Eventos ---
+// O simulador (produtor) so copia o registro para o anel; a formatacao e a
+// escrita ficam com outra thread (arquivo) ou com o fim do ciclo (tela, no
+// modo interativo). No arquivo nenhum evento e descartado: com o anel cheio o
+// produtor espera a thread de escrita liberar espaco. Na tela so interessam os
+// eventos do ciclo exibido, e com o anel cheio os mais antigos sao descartados.
+class EventLog {
+public:
+    EventLog();
+    ~EventLog();
+
+    // Destino binario, drenado por uma thread de escrita
+    bool open_file(const std::string& filename, const EventLogHeader& header);
+    // Destino tela, drenado por render_pending() na thread do simulador
+    void open_screen(const EventLogHeader& header);
+    // Drena o que falta, encerra a thread e fecha o arquivo
+    bool close();
+
+    bool is_open() const { return to_screen || file != nullptr; }
+    LogLevel level() const { return (LogLevel)header.level; }
+
+    void push(const LogEvent& event) {
+        uint64_t t = tail.load(std::memory_order_relaxed);
+        if (t - seen_head == ring.size()) wait_for_space();
+        ring[t & mask] = event;
+        tail.store(t + 1, std::memory_order_release);
+    }
+
+    // Destino tela: acrescenta o texto dos eventos pendentes a 'lines' (uma
+    // linha por evento) ou os descarta
+    void render_pending(std::vector<std::string>& lines);
+    void discard_pending();
+
+private:
+    std::vector<LogEvent> ring;
+    uint64_t mask;
+    std::atomic<uint64_t> head;     // proximo registro a escrever (thread de escrita)
+    std::atomic<uint64_t> tail;     // proximo registro a preencher (simulador)
+    uint64_t seen_head;             // ultimo 'head' lido pelo simulador (evita ler o atomico a cada evento)
+    std::atomic<bool> closing;
+    std::atomic<bool> failed;
+    std::thread writer;
+    FILE* file;
+    bool to_screen;
+    EventLogHeader header;
+    std::string name;
+
+    void wait_for_space();
+    void drain_file();
+    void writer_loop();
+
+    EventLog(const EventLog&) = delete;
+    EventLog& operator=(const EventLog&) = delete;
+};
+
+#endif // EVENTLOG_H
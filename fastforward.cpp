@@ -0,0 +1,104 @@
+#include "simulator.h"
+#include <iostream>
+#include <iomanip>
+#include <chrono>
+#include <climits>
+
+// --- Fast-forward Funcional ---
+// O inicio do trace e executado em ordem de programa direto sobre reg_file e
+// memory, sem estacoes, ROB, caches ou ciclos. No fim o pipeline comeca vazio
+// na instrucao seguinte, como se todas as anteriores ja tivessem comprometido.
+
+namespace {
+
+// Mesmo resultado que o pipeline grava no commit
+inline void execute_functional(const DecodedInst& code, double* regs, PagedMemory& memory) {
+    switch (code.op) {
+        case OP_ADD: regs[code.dest] = regs[code.src1] + regs[code.src2]; break;
+        case OP_SUB: regs[code.dest] = regs[code.src1] - regs[code.src2]; break;
+        case OP_MUL: regs[code.dest] = regs[code.src1] * regs[code.src2]; break;
+        case OP_DIV: {
+            double divisor = regs[code.src2];
+            regs[code.dest] = (divisor == 0) ? 0.0 : regs[code.src1] / divisor;
+            break;
+        }
+        case OP_LOAD: regs[code.dest] = memory.read((long)(regs[code.src1] + code.offset)); break;
+        case OP_STORE: memory.write((long)(regs[code.src1] + code.offset), regs[code.dest]); break;
+        default: break;
+    }
+}
+
+}
+
+void Simulator::fast_forward() {
+    bool to_roi = config.fast_forward < 0;
+    long limit = to_roi ? LONG_MAX : config.fast_forward;
+    double* regs = reg_file.data();
+    long executed = 0;
+    bool found = false;     // marcador #@roi alcancado
+    auto start = std::chrono::steady_clock::now();
+
+    if (source) {
+        // Trace lido sob demanda: o marcador so e conhecido quando a leitura
+        // passa por ele, e a instrucao ja lida vai para a janela
+        DecodedInst code;
+        bool pending = false;
+        while (executed < limit) {
+            if (!source->next(code)) {
+                // Marcador depois da ultima instrucao: a regiao medida e vazia
+                found = to_roi && source->roi_start() == executed;
+                source_done = true;
+                source.reset();
+                break;
+            }
+            long roi = to_roi ? source->roi_start() : -1;
+            if (roi >= 0 && roi <= executed) {
+                found = pending = true;
+                break;
+            }
+            if (!check_fetched(code, executed)) break;
+            execute_functional(code, regs, memory);
+            ++executed;
+        }
+        fetched = executed;
+        if (pending && check_fetched(code, executed)) store_fetched(code);
+    } else {
+        long end = std::min(fetched, limit);
+        if (to_roi && roi_seq >= 0) {
+            end = roi_seq;
+            found = true;
+        }
+        for (long seq = 0; seq < end; ++seq) {
+            Instruction& inst = inst_at(seq);
+            execute_functional(inst, regs, memory);
+            inst.state = COMMITTED;
+        }
+        executed = end;
+    }
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    pc = executed;
+    committed_inst_count = executed;
+    rob.head = rob.tail = executed;
+    stats.fast_forwarded = executed;
+    if (bad_trace) return;
+
+    if (to_roi && !found) {
+        std::cerr << "Marcador #@roi nao encontrado: o trace inteiro foi executado no fast-forward" << std::endl;
+    }
+    if (mode != MODE_SILENT) {
+        std::cout << "Fast-forward: " << executed << " instrucoes em " << std::fixed << std::setprecision(3) << seconds << " s";
+        if (seconds > 0) std::cout << " (" << std::setprecision(1) << executed / seconds / 1e6 << " M instrucoes/s)";
+        std::cout << std::endl;
+    }
+}
+
+// Fim do aquecimento: caches, estacoes e ROB ja refletem o programa e o
+// intervalo medido comeca aqui
+void Simulator::end_warmup() {
+    warmup_end = 0;
+    stats.start_cycle = cycle;
+    stats.start_committed = committed_inst_count - stats.fast_forwarded;
+    stats.warmed_up = true;
+    if (mode != MODE_SILENT) std::cout << "Aquecimento concluido no ciclo " << cycle << std::endl;
+}
@@ -0,0 +1,88 @@
+// --- Renderizador do Log de Eventos ---
+// Ferramenta separada: le o arquivo gravado com --log-out e imprime os
+// eventos no mesmo texto do modo interativo. Compilar com:
+//   g++ -O2 -o log_render log_render.cpp eventlog.cpp trace.cpp -std=c++14 -pthread
+#include "eventlog.h"
+#include <iostream>
+#include <fstream>
+#include <cstring>
+#include <cstdlib>
+#include <climits>
+
+static void print_usage(const char* prog) {
+    std::cerr << "Uso: " << prog << " [opcoes] <log>" << std::endl;
+    std::cerr << "  --from N             comeca no ciclo N" << std::endl;
+    std::cerr << "  --to N               para depois do ciclo N" << std::endl;
+    std::cerr << "Ex: " << prog << " --from 100 --to 120 eventos.log" << std::endl;
+}
+
+int main(int argc, char* argv[]) {
+    const char* filename = nullptr;
+    long from = 0, to = LONG_MAX;
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "--from" || arg == "--to") {
+            char* end = nullptr;
+            long value = (i + 1 < argc) ? std::strtol(argv[i + 1], &end, 10) : -1;
+            if (i + 1 >= argc || end == argv[i + 1] || *end != '\0' || value < 0) {
+                std::cerr << "Valor invalido para " << arg << std::endl;
+                return EXIT_FAILURE;
+            }
+            (arg == "--from" ? from : to) = value;
+            ++i;
+        } else if (filename == nullptr && !arg.empty() && arg[0] != '-') {
+            filename = argv[i];
+        } else {
+            print_usage(argv[0]);
+            return EXIT_FAILURE;
+        }
+    }
+    if (filename == nullptr) {
+        print_usage(argv[0]);
+        return EXIT_FAILURE;
+    }
+
+    std::ifstream in(filename, std::ios::binary);
+    if (!in) {
+        std::cerr << "Erro ao abrir log de eventos: " << filename << std::endl;
+        return EXIT_FAILURE;
+    }
+    EventLogHeader header = EventLogHeader();
+    in.read((char*)&header, sizeof(header));
+    if (!in || memcmp(header.magic, EVENT_LOG_MAGIC, 8) != 0) {
+        std::cerr << filename << ": nao e um log de eventos" << std::endl;
+        return EXIT_FAILURE;
+    }
+    if (header.version != EVENT_LOG_VERSION || header.record_size != sizeof(LogEvent)) {
+        std::cerr << filename << ": versao " << header.version << " com registros de " << header.record_size
+                  << " bytes (esperado versao " << EVENT_LOG_VERSION << ", " << sizeof(LogEvent) << " bytes)" << std::endl;
+        return EXIT_FAILURE;
+    }
+    if (header.add_rs < 0 || header.mul_rs < 0 || header.ls_buffers < 0) {
+        std::cerr << filename << ": cabecalho corrompido" << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    // Registros lidos em blocos, em ordem de ciclo: o primeiro depois de 'to' encerra a leitura
+    std::vector<LogEvent> block(4096);
+    bool done = false;
+    while (!done) {
+        in.read((char*)block.data(), block.size() * sizeof(LogEvent));
+        size_t n = (size_t)in.gcount() / sizeof(LogEvent);
+        for (size_t k = 0; k < n && !done; ++k) {
+            const LogEvent& e = block[k];
+            long last = (e.kind == EV_SKIP) ? (long)e.a : (long)e.cycle;   // ciclos pulados cobrem um intervalo
+            if (e.cycle > to) done = true;
+            else if (last >= from) std::cout << render_event(e, header) << '\n';
+        }
+        if (!done && n < block.size()) {
+            if (in.gcount() % sizeof(LogEvent) != 0) {
+                std::cerr << filename << ": ultimo registro incompleto (log truncado)" << std::endl;
+                return EXIT_FAILURE;
+            }
+            done = true;
+        }
+    }
+    std::cout.flush();
+    return EXIT_SUCCESS;
+}
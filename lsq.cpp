@@ -0,0 +1,56 @@
+#include "lsq.h"
+#include <algorithm>
+
+void StoreQueue::clear() {
+    entries.clear();
+    by_address.clear();
+    first_number = 0;
+    resolved_prefix = 0;
+}
+
+long StoreQueue::push(long seq, int slot) {
+    entries.push_back(Entry{seq, slot, false, 0});
+    return first_number + (long)entries.size() - 1;
+}
+
+void StoreQueue::resolve(long number, long address) {
+    Entry& entry = entries[number - first_number];
+    entry.resolved = true;
+    entry.address = address;
+
+    // Enderecos sao calculados fora de ordem: mantem os numeros ordenados
+    std::vector<long>& numbers = by_address[address];
+    numbers.insert(std::upper_bound(numbers.begin(), numbers.end(), number), number);
+
+    while (resolved_prefix < (long)entries.size() && entries[resolved_prefix].resolved) {
+        ++resolved_prefix;
+    }
+}
+
+void StoreQueue::retire() {
+    const Entry& entry = entries.front();
+    if (entry.resolved) {
+        auto it = by_address.find(entry.address);
+        std::vector<long>& numbers = it->second;
+        numbers.erase(numbers.begin());   // o mais antigo do endereco e o que sai
+        if (numbers.empty()) by_address.erase(it);
+    }
+    entries.pop_front();
+    ++first_number;
+    if (resolved_prefix > 0) --resolved_prefix;
+}
+
+bool StoreQueue::unresolved_before(long seq) const {
+    return resolved_prefix < (long)entries.size() && entries[resolved_prefix].seq < seq;
+}
+
+long StoreQueue::youngest_before(long address, long seq) const {
+    auto it = by_address.find(address);
+    if (it == by_address.end()) return -1;
+    const std::vector<long>& numbers = it->second;
+    // Os numeros crescem com a sequencia: procura o ultimo STORE anterior a 'seq'
+    for (auto n = numbers.rbegin(); n != numbers.rend(); ++n) {
+        if (entries[*n - first_number].seq < seq) return *n;
+    }
+    return -1;
+}
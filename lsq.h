@@ -0,0 +1,57 @@
+#ifndef LSQ_H
+#define LSQ_H
+
+#include <deque>
+#include <vector>
+#include <unordered_map>
+
+// --- Fila de STOREs em Voo (Load/Store Queue) ---
+// Guarda, em ordem de programa, os STOREs emitidos e ainda nao comprometidos,
+// com um indice por endereco. A memoria so e escrita no commit, entao um LOAD
+// precisa conhecer apenas os STOREs mais antigos que ele ainda em voo:
+//   - se algum deles ainda nao tem endereco, o LOAD espera (desambiguacao
+//     conservadora, sem especulacao);
+//   - senao o mais novo deles no mesmo endereco (se houver) fornece o valor.
+// As duas consultas custam O(1) (amortizado), sem varrer os buffers L/S.
+// Cada STORE e identificado pelo seu numero na fila (crescente, em ordem de programa).
+class StoreQueue {
+public:
+    StoreQueue() : first_number(0), resolved_prefix(0) {}
+
+    void clear();
+
+    // STORE 'seq' emitido no buffer L/S 'slot'; retorna o numero dele na fila
+    long push(long seq, int slot);
+
+    // Endereco do STORE 'number' calculado
+    void resolve(long number, long address);
+
+    // Commit do STORE mais antigo (sempre a frente da fila)
+    void retire();
+
+    bool empty() const { return entries.empty(); }
+    long seq(long number) const { return entries[number - first_number].seq; }
+    int slot(long number) const { return entries[number - first_number].slot; }
+
+    // Ha STORE mais antigo que 'seq' ainda sem endereco?
+    bool unresolved_before(long seq) const;
+
+    // Numero do STORE mais novo, anterior a 'seq', que escreve em 'address' (-1 = nenhum)
+    long youngest_before(long address, long seq) const;
+
+private:
+    struct Entry {
+        long seq;
+        int slot;       // buffer L/S (valido ate o writeback do STORE)
+        bool resolved;  // endereco ja calculado
+        long address;
+    };
+    std::deque<Entry> entries;
+    long first_number;      // numero do STORE na frente da fila
+    long resolved_prefix;   // quantos STOREs na frente da fila ja tem endereco
+
+    // Endereco -> numeros dos STOREs em voo naquele endereco, em ordem crescente
+    std::unordered_map<long, std::vector<long>> by_address;
+};
+
+#endif // LSQ_H
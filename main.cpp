@@ -1,22 +1,217 @@
-#include "simulator.h"
-#include <cstdlib>
-
-int main(int argc, char* argv[]) {
-    if (argc != 2) {
-        std::cerr << "Uso: " << argv[0] << " <arquivo_de_instrucoes>" << std::endl;
-        std::cerr << "Ex: " << argv[0] << " instructions.txt" << std::endl;
-        return EXIT_FAILURE;
-    }
-
-    Simulator sim;
-    
-    // Carrega instrucoes
-    if (!sim.load_instructions(argv[1])) {
-        return EXIT_FAILURE;
-    }
-
-    // Executa a simulacao
-    sim.run();
-
-    return EXIT_SUCCESS;
-}
\ No newline at end of file
+#include "simulator.h"
+#include "sweep.h"
+#include "workload.h"
+#include "bench.h"
+#include "multicore.h"
+#include "ensemble.h"
+#include <cstdlib>
+
+static void print_usage(const char* prog) {
+    std::cerr << "Uso: " << prog << " [opcoes] <arquivo_de_instrucoes>" << std::endl;
+    std::cerr << "  --batch, -b          roda sem pausas e imprime apenas o resumo final" << std::endl;
+    std::cerr << "  --quiet, -q          roda sem pausas e sem nenhuma saida" << std::endl;
+    std::cerr << "  --window N           modo streaming: le o trace sob demanda com janela de N instrucoes" << std::endl;
+    std::cerr << "  --timing-out ARQ     grava os tempos de cada instrucao (CSV) no commit" << std::endl;
+    std::cerr << "  --counters-out ARQ   grava contadores de desempenho e pilha de CPI (JSON) ao final" << std::endl;
+    std::cerr << "  --checkpoint-every N grava um checkpoint a cada N ciclos" << std::endl;
+    std::cerr << "  --checkpoint-out P   prefixo dos checkpoints (P.<ciclo>.ckpt, padrao 'checkpoint')" << std::endl;
+    std::cerr << "  --restore ARQ        continua a partir de um checkpoint (o limite de ciclos conta dali)" << std::endl;
+    std::cerr << "  --config ARQ         configuracao da maquina (arquivo chave = valor)" << std::endl;
+    std::cerr << "  --set CHAVE=VALOR    sobrescreve uma chave da configuracao (pode repetir)" << std::endl;
+    std::cerr << "  --max-cycles N       limite de ciclos (padrao 500, 0 = sem limite)" << std::endl;
+    std::cerr << "  --mem-image ARQ      memoria inicial mapeada de um arquivo binario de doubles" << std::endl;
+    std::cerr << "  --mem-base N         endereco da primeira palavra da imagem (padrao 0)" << std::endl;
+    std::cerr << "  --rob N              numero de entradas do ROB (padrao 0 = ilimitado)" << std::endl;
+    std::cerr << "  --commit-width N     commits por ciclo (padrao 0 = ilimitado)" << std::endl;
+    std::cerr << "  --log-out ARQ        grava o log de eventos (binario; ver log_render) com --batch/--quiet" << std::endl;
+    std::cerr << "  --log-level NIVEL    off, summary (um registro por ciclo) ou events (padrao)" << std::endl;
+    std::cerr << "  --fast-forward N|roi executa as primeiras N instrucoes (ou ate o marcador #@roi) sem simular ciclos" << std::endl;
+    std::cerr << "  --warmup N           N instrucoes no pipeline antes do intervalo medido" << std::endl;
+    std::cerr << "Ex: " << prog << " instructions.txt" << std::endl;
+    std::cerr << "Varredura de configuracoes: " << prog << " sweep --help" << std::endl;
+    std::cerr << "Trace binario pre-decodificado: " << prog << " convert <trace.txt> <trace.bin>" << std::endl;
+    std::cerr << "Carga sintetica: " << prog << " gen [chave=valor ...] <saida>" << std::endl;
+    std::cerr << "Velocidade do simulador: " << prog << " bench [--save ARQ | --baseline ARQ]" << std::endl;
+    std::cerr << "Varios nucleos com memoria compartilhada: " << prog << " multicore <trace0> <trace1> ..." << std::endl;
+    std::cerr << "Muitos traces pequenos em conjunto: " << prog << " ensemble --list ARQ" << std::endl;
+}
+
+// Subcomando "convert": trace em texto -> trace binario (lido direto por mmap)
+static int run_convert(int argc, char* argv[]) {
+    if (argc != 3) {
+        std::cerr << "Uso: simulador convert <trace.txt> <trace.bin>" << std::endl;
+        return (argc == 2 && std::string(argv[1]) == "--help") ? EXIT_SUCCESS : EXIT_FAILURE;
+    }
+    long records = 0;
+    if (!convert_trace(argv[1], argv[2], records)) return EXIT_FAILURE;
+    std::cout << records << " instrucoes gravadas em " << argv[2] << std::endl;
+    return EXIT_SUCCESS;
+}
+
+// Le o valor numerico da opcao argv[i] (em argv[i + 1])
+static bool parse_long_arg(int argc, char* argv[], int& i, long& value) {
+    if (i + 1 >= argc) {
+        std::cerr << "Opcao " << argv[i] << " exige um valor" << std::endl;
+        return false;
+    }
+    char* end = nullptr;
+    value = std::strtol(argv[i + 1], &end, 10);
+    if (end == argv[i + 1] || *end != '\0' || value < 0) {
+        std::cerr << "Valor invalido para " << argv[i] << ": " << argv[i + 1] << std::endl;
+        return false;
+    }
+    ++i;
+    return true;
+}
+
+int main(int argc, char* argv[]) {
+    // Subcomando de varredura do espaco de projeto
+    if (argc > 1 && std::string(argv[1]) == "sweep") {
+        return run_sweep(argc - 1, argv + 1);
+    }
+    if (argc > 1 && std::string(argv[1]) == "convert") {
+        return run_convert(argc - 1, argv + 1);
+    }
+    if (argc > 1 && std::string(argv[1]) == "gen") {
+        return run_generate(argc - 1, argv + 1);
+    }
+    if (argc > 1 && std::string(argv[1]) == "bench") {
+        return run_bench(argc - 1, argv + 1);
+    }
+    if (argc > 1 && std::string(argv[1]) == "multicore") {
+        return run_multicore(argc - 1, argv + 1);
+    }
+    if (argc > 1 && std::string(argv[1]) == "ensemble") {
+        return run_ensemble(argc - 1, argv + 1);
+    }
+
+    RunMode mode = MODE_INTERACTIVE;
+    const char* filename = nullptr;
+    const char* timing_file = nullptr;
+    const char* counters_file = nullptr;
+    const char* log_file = nullptr;
+    const char* restore_file = nullptr;
+    const char* checkpoint_prefix = "checkpoint";
+    long checkpoint_every = 0;
+    const char* config_file = nullptr;
+    long window = 0;
+
+    // Sobrescritas "chave=valor" da linha de comando, aplicadas depois do
+    // arquivo de configuracao e na ordem em que aparecem
+    std::vector<std::string> overrides;
+
+    // Atalhos para chaves da configuracao
+    const char* shortcuts[][2] = {
+        {"--max-cycles", "max_cycles"},
+        {"--rob", "rob_size"},
+        {"--commit-width", "commit_width"},
+        {"--mem-image", "mem_image"},
+        {"--mem-base", "mem_base"},
+        {"--log-level", "log_level"},
+        {"--fast-forward", "fast_forward"},
+        {"--warmup", "warmup"},
+    };
+
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        const char* key = nullptr;
+        for (auto const& shortcut : shortcuts) {
+            if (arg == shortcut[0]) key = shortcut[1];
+        }
+
+        if (arg == "--batch" || arg == "-b") mode = MODE_BATCH;
+        else if (arg == "--quiet" || arg == "-q") mode = MODE_SILENT;
+        else if (arg == "--window") {
+            if (!parse_long_arg(argc, argv, i, window)) return EXIT_FAILURE;
+        } else if (arg == "--checkpoint-every") {
+            if (!parse_long_arg(argc, argv, i, checkpoint_every)) return EXIT_FAILURE;
+        } else if (key != nullptr || arg == "--set" || arg == "--config" || arg == "--timing-out" ||
+                   arg == "--counters-out" || arg == "--checkpoint-out" || arg == "--restore" || arg == "--log-out") {
+            if (i + 1 >= argc) {
+                std::cerr << "Opcao " << arg << " exige um valor" << std::endl;
+                return EXIT_FAILURE;
+            }
+            std::string value = argv[++i];
+            if (key != nullptr) overrides.push_back(std::string(key) + "=" + value);
+            else if (arg == "--set") overrides.push_back(value);
+            else if (arg == "--config") config_file = argv[i];
+            else if (arg == "--counters-out") counters_file = argv[i];
+            else if (arg == "--checkpoint-out") checkpoint_prefix = argv[i];
+            else if (arg == "--restore") restore_file = argv[i];
+            else if (arg == "--log-out") log_file = argv[i];
+            else timing_file = argv[i];
+        } else if (arg == "--help" || arg == "-h") {
+            print_usage(argv[0]);
+            return EXIT_SUCCESS;
+        } else if (!arg.empty() && arg[0] == '-') {
+            std::cerr << "Opcao desconhecida: " << arg << std::endl;
+            print_usage(argv[0]);
+            return EXIT_FAILURE;
+        } else if (filename == nullptr) filename = argv[i];
+        else {
+            print_usage(argv[0]);
+            return EXIT_FAILURE;
+        }
+    }
+
+    if (filename == nullptr) {
+        print_usage(argv[0]);
+        return EXIT_FAILURE;
+    }
+
+    if (log_file != nullptr && mode == MODE_INTERACTIVE) {
+        std::cerr << "--log-out exige --batch ou --quiet (no modo interativo os eventos vao para a tela)" << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    // Configuracao: padrao -> arquivo -> linha de comando
+    SimConfig config;
+    if (config_file != nullptr && !config.load_file(config_file)) {
+        return EXIT_FAILURE;
+    }
+    for (const std::string& assignment : overrides) {
+        if (!config.apply(assignment, "linha de comando")) return EXIT_FAILURE;
+    }
+    if (!config.validate("configuracao")) return EXIT_FAILURE;
+    if (restore_file != nullptr && config.fast_forward != 0) {
+        std::cerr << "fast_forward nao se aplica com --restore (o checkpoint ja define o ponto de partida)" << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    Simulator sim(config, mode);
+    if (timing_file != nullptr && !sim.open_timing_output(timing_file)) {
+        return EXIT_FAILURE;
+    }
+    if (counters_file != nullptr && !sim.open_counters_output(counters_file)) {
+        return EXIT_FAILURE;
+    }
+    if (log_file != nullptr && !sim.open_event_log(log_file)) {
+        return EXIT_FAILURE;
+    }
+    if (checkpoint_every > 0) sim.schedule_checkpoints(checkpoint_every, checkpoint_prefix);
+
+    if (restore_file != nullptr) {
+        // Estado, memoria e posicao no trace vem do checkpoint
+        if (!sim.restore_checkpoint(restore_file, filename)) return EXIT_FAILURE;
+    } else {
+        if (!sim.init_memory()) {
+            return EXIT_FAILURE;
+        }
+
+        // Carrega instrucoes (inteiras ou sob demanda, no modo streaming). Com
+        // checkpoints o trace e sempre lido sob demanda (janela elastica se
+        // --window nao foi dado), para que a posicao no arquivo seja conhecida.
+        // Traces binarios tambem, fora do modo interativo: os registros vem
+        // direto do mapeamento e so as instrucoes em voo ocupam a janela.
+        bool stream = window > 0 || checkpoint_every > 0 || (mode != MODE_INTERACTIVE && is_binary_trace(filename));
+        bool loaded = stream ? sim.open_stream(filename, (int)window) : sim.load_instructions(filename);
+        if (!loaded) {
+            return EXIT_FAILURE;
+        }
+    }
+
+    // Executa a simulacao
+    sim.run();
+
+    return sim.trace_failed() ? EXIT_FAILURE : EXIT_SUCCESS;
+}
@@ -0,0 +1,168 @@
+#include "memory.h"
+#include <iostream>
+#include <algorithm>
+#include <cstring>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+PagedMemory::PagedMemory()
+    : last_number(0), last_page(nullptr),
+      image_map(nullptr), image_bytes(0), image_base(0), image_words(0) {}
+
+PagedMemory::~PagedMemory() {
+    clear();
+}
+
+void PagedMemory::clear() {
+    pages.clear();
+    last_page = nullptr;
+    if (image_map != nullptr) {
+        munmap(image_map, image_bytes);
+        image_map = nullptr;
+    }
+    image_bytes = 0;
+    image_base = 0;
+    image_words = 0;
+}
+
+// --- Acesso ---
+
+double PagedMemory::read(long address) {
+    long number = address >> PAGE_BITS;
+    long index = address & (PAGE_WORDS - 1);
+    if (last_page != nullptr && number == last_number) return last_page->data[index];
+
+    auto it = pages.find(number);
+    if (it != pages.end()) {
+        last_number = number;
+        last_page = &it->second;
+        return last_page->data[index];
+    }
+
+    // Pagina nunca tocada: so vale a pena cria-la se a imagem a cobre
+    if (image_words > 0 && address >= image_base && address < image_base + image_words) {
+        return page_for(number).data[index];
+    }
+    return 0.0;
+}
+
+double PagedMemory::peek(long address) const {
+    auto it = pages.find(address >> PAGE_BITS);
+    if (it != pages.end()) return it->second.data[address & (PAGE_WORDS - 1)];
+    if (image_words > 0 && address >= image_base && address < image_base + image_words) {
+        return ((const double*)image_map)[address - image_base];
+    }
+    return 0.0;
+}
+
+void PagedMemory::write(long address, double value) {
+    long index = address & (PAGE_WORDS - 1);
+    Page& page = page_for(address >> PAGE_BITS);
+    page.data[index] = value;
+    page.written[index >> 6] |= (uint64_t)1 << (index & 63);
+}
+
+// Localiza a pagina, criando-a (zerada ou com o conteudo da imagem) no primeiro acesso
+PagedMemory::Page& PagedMemory::page_for(long number) {
+    if (last_page != nullptr && number == last_number) return *last_page;
+
+    auto it = pages.find(number);
+    if (it == pages.end()) {
+        it = pages.emplace(number, Page()).first;
+        Page& page = it->second;
+        page.data = nullptr;
+        page.written.assign(PAGE_WORDS / 64, 0);
+        fill_from_image(number, page);
+        if (page.data == nullptr) {
+            page.own.reset(new double[PAGE_WORDS]());
+            page.data = page.own.get();
+        }
+    }
+    last_number = number;
+    last_page = &it->second;
+    return *last_page;
+}
+
+// Preenche a pagina com a parte da imagem que ela cobre. Paginas inteiramente
+// dentro de uma imagem alinhada apontam direto para o mapeamento; as demais
+// (bordas ou base desalinhada) recebem uma copia do trecho sobreposto.
+void PagedMemory::fill_from_image(long number, Page& page) {
+    if (image_words == 0) return;
+    long start = number << PAGE_BITS;
+    long first = std::max(start, image_base);
+    long last = std::min(start + PAGE_WORDS, image_base + image_words);
+    if (first >= last) return;
+
+    const double* image = (const double*)image_map;
+    if (first == start && last == start + PAGE_WORDS) {
+        page.data = (double*)image + (start - image_base);
+        return;
+    }
+    page.own.reset(new double[PAGE_WORDS]());
+    page.data = page.own.get();
+    std::memcpy(page.data + (first - start), image + (first - image_base),
+                (size_t)(last - first) * sizeof(double));
+}
+
+
+// --- Imagem Inicial ---
+
+bool PagedMemory::load_image(const std::string& filename, long base) {
+    clear();
+
+    int fd = ::open(filename.c_str(), O_RDONLY);
+    if (fd < 0) {
+        std::cerr << "Erro ao abrir imagem de memoria: " << filename << std::endl;
+        return false;
+    }
+    struct stat st;
+    if (fstat(fd, &st) != 0 || !S_ISREG(st.st_mode) || st.st_size % sizeof(double) != 0) {
+        std::cerr << "Imagem de memoria invalida (esperado arquivo com doubles de 8 bytes): "
+                  << filename << std::endl;
+        ::close(fd);
+        return false;
+    }
+    if (st.st_size == 0) {
+        ::close(fd);
+        return true;
+    }
+
+    // Mapeamento privado e gravavel: STOREs sobre a imagem nao alteram o arquivo
+    void* m = mmap(nullptr, (size_t)st.st_size, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+    ::close(fd);
+    if (m == MAP_FAILED) {
+        std::cerr << "Erro ao mapear imagem de memoria: " << filename << std::endl;
+        return false;
+    }
+    image_map = m;
+    image_bytes = (size_t)st.st_size;
+    image_base = base;
+    image_words = (long)(image_bytes / sizeof(double));
+    return true;
+}
+
+
+// --- Listagem ---
+
+std::vector<std::pair<long, double>> PagedMemory::written_cells() const {
+    std::vector<long> numbers;
+    numbers.reserve(pages.size());
+    for (auto const& entry : pages) numbers.push_back(entry.first);
+    std::sort(numbers.begin(), numbers.end());
+
+    std::vector<std::pair<long, double>> cells;
+    for (long number : numbers) {
+        const Page& page = pages.at(number);
+        for (long w = 0; w < PAGE_WORDS / 64; ++w) {
+            uint64_t bits = page.written[w];
+            while (bits != 0) {
+                long index = w * 64 + __builtin_ctzll(bits);
+                cells.push_back(std::make_pair((number << PAGE_BITS) + index, page.data[index]));
+                bits &= bits - 1;
+            }
+        }
+    }
+    return cells;
+}
@@ -0,0 +1,68 @@
+#ifndef MEMORY_H
+#define MEMORY_H
+
+#include <string>
+#include <vector>
+#include <memory>
+#include <unordered_map>
+#include <cstddef>
+#include <cstdint>
+
+// --- Memoria Paginada Esparsa ---
+// Cada endereco guarda um double. Os enderecos sao agrupados em paginas de
+// PAGE_WORDS posicoes, alocadas no primeiro acesso e localizadas por uma
+// tabela hash de numeros de pagina (com cache da ultima pagina usada).
+// Uma imagem inicial pode ser mapeada de um arquivo binario: as paginas da
+// imagem apontam direto para o mapeamento (MAP_PRIVATE, copia na escrita
+// feita pelo sistema), entao carregar centenas de MB nao le nada do disco.
+class PagedMemory {
+public:
+    static const int PAGE_BITS = 12;
+    static const long PAGE_WORDS = 1L << PAGE_BITS;
+
+    PagedMemory();
+    ~PagedMemory();
+
+    double read(long address);
+    void write(long address, double value);
+    // Mesmo valor que read, sem criar pagina nem mudar o cache (consultas)
+    double peek(long address) const;
+
+    // Apaga todo o conteudo (e desfaz o mapeamento da imagem, se houver)
+    void clear();
+
+    // Mapeia 'filename' (doubles de 8 bytes na ordem nativa) a partir do
+    // endereco 'base': a palavra i do arquivo fica no endereco base + i
+    bool load_image(const std::string& filename, long base);
+
+    // Enderecos escritos (valores iniciais e STOREs), em ordem crescente.
+    // Posicoes vindas apenas da imagem nao sao listadas.
+    std::vector<std::pair<long, double>> written_cells() const;
+
+    size_t page_count() const { return pages.size(); }
+
+private:
+    struct Page {
+        double* data;                   // PAGE_WORDS valores
+        std::unique_ptr<double[]> own;  // dono de data, exceto paginas mapeadas da imagem
+        std::vector<uint64_t> written;  // bitmap das posicoes escritas
+    };
+
+    std::unordered_map<long, Page> pages;
+    long last_number;   // cache da ultima pagina acessada
+    Page* last_page;
+
+    // Imagem mapeada
+    void* image_map;
+    size_t image_bytes;
+    long image_base;
+    long image_words;
+
+    Page& page_for(long number);
+    void fill_from_image(long number, Page& page);
+
+    PagedMemory(const PagedMemory&) = delete;
+    PagedMemory& operator=(const PagedMemory&) = delete;
+};
+
+#endif // MEMORY_H
@@ -0,0 +1,210 @@
+#include "multicore.h"
+#include "simulator.h"
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <algorithm>
+#include <chrono>
+#include <iomanip>
+#include <cstdlib>
+
+namespace {
+
+// --- Barreira entre as Threads ---
+// A ultima thread a chegar libera as demais; 'generation' distingue uma
+// rodada da seguinte
+class Barrier {
+public:
+    explicit Barrier(int count) : count(count), waiting(0), generation(0) {}
+
+    void wait() {
+        std::unique_lock<std::mutex> guard(lock);
+        long gen = generation;
+        if (++waiting == count) {
+            waiting = 0;
+            ++generation;
+            released.notify_all();
+            return;
+        }
+        released.wait(guard, [&] { return gen != generation; });
+    }
+
+private:
+    std::mutex lock;
+    std::condition_variable released;
+    int count;
+    int waiting;
+    long generation;
+};
+
+// STORE publicado na fronteira do quantum, com o nucleo de origem
+struct SharedStore {
+    StoreRecord store;
+    int core;
+};
+
+struct Core {
+    std::unique_ptr<Simulator> sim;
+    std::string trace;
+    long published = 0;     // STOREs enviados aos outros nucleos
+};
+
+void print_multicore_usage() {
+    std::cerr << "Uso: simulador multicore [opcoes] <trace0> <trace1> [...]" << std::endl;
+    std::cerr << "  --quantum N          ciclos entre as sincronizacoes da memoria (padrao 100)" << std::endl;
+    std::cerr << "  --threads N          numero de threads (padrao: um por nucleo, ate o numero de nucleos da maquina)" << std::endl;
+    std::cerr << "  --config ARQ         configuracao de todos os nucleos (arquivo chave = valor)" << std::endl;
+    std::cerr << "  --set CHAVE=VALOR    sobrescreve uma chave da configuracao (pode repetir)" << std::endl;
+    std::cerr << "Ex: simulador multicore --quantum 50 --set max_cycles=0 produtor.txt consumidor.txt" << std::endl;
+}
+
+}
+
+int run_multicore(int argc, char* argv[]) {
+    std::vector<std::string> traces;
+    std::vector<std::string> overrides;
+    const char* config_file = nullptr;
+    long quantum = 100;
+    int threads = 0;
+
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        bool takes_value = arg == "--quantum" || arg == "--threads" || arg == "--config" || arg == "--set";
+        if (takes_value) {
+            if (i + 1 >= argc) {
+                std::cerr << "Opcao " << arg << " exige um valor" << std::endl;
+                return EXIT_FAILURE;
+            }
+            std::string value = argv[++i];
+            if (arg == "--config") config_file = argv[i];
+            else if (arg == "--set") overrides.push_back(value);
+            else {
+                char* end = nullptr;
+                long n = std::strtol(value.c_str(), &end, 10);
+                if (value.empty() || *end != '\0' || n < 1 || (arg == "--threads" && n > 4096)) {
+                    std::cerr << "Valor invalido para " << arg << ": " << value << std::endl;
+                    return EXIT_FAILURE;
+                }
+                if (arg == "--quantum") quantum = n;
+                else threads = (int)n;
+            }
+        } else if (arg == "--help") {
+            print_multicore_usage();
+            return EXIT_SUCCESS;
+        } else if (!arg.empty() && arg[0] == '-') {
+            std::cerr << "Opcao desconhecida: " << arg << std::endl;
+            print_multicore_usage();
+            return EXIT_FAILURE;
+        } else {
+            traces.push_back(arg);
+        }
+    }
+    if (traces.empty()) {
+        print_multicore_usage();
+        return EXIT_FAILURE;
+    }
+
+    SimConfig config;
+    if (config_file != nullptr && !config.load_file(config_file)) return EXIT_FAILURE;
+    for (const std::string& assignment : overrides) {
+        if (!config.apply(assignment, "linha de comando")) return EXIT_FAILURE;
+    }
+    if (!config.validate("configuracao")) return EXIT_FAILURE;
+
+    // Todos os nucleos partem da mesma memoria inicial
+    std::vector<Core> cores(traces.size());
+    for (size_t c = 0; c < cores.size(); ++c) {
+        Core& core = cores[c];
+        core.trace = traces[c];
+        core.sim.reset(new Simulator(config, MODE_SILENT));
+        if (!core.sim->init_memory()) return EXIT_FAILURE;
+        bool loaded = is_binary_trace(core.trace) ? core.sim->open_stream(core.trace, 0)
+                                                  : core.sim->load_instructions(core.trace);
+        if (!loaded) return EXIT_FAILURE;
+        core.sim->record_stores(true);
+    }
+
+    if (threads == 0) threads = (int)std::max(1u, std::thread::hardware_concurrency());
+    int n = (int)std::min<size_t>(threads, cores.size());
+
+    // Cada thread simula os nucleos t, t + n, ... ate a fronteira do quantum.
+    // Entre as duas barreiras a thread 0 junta os STOREs de todos; depois
+    // cada thread os aplica nos seus nucleos.
+    Barrier barrier(n);
+    std::vector<SharedStore> merged;
+    long boundary = quantum;
+    long quanta = 0;
+    long shared_stores = 0;
+    bool finished = false;
+    auto start = std::chrono::steady_clock::now();
+
+    auto worker = [&](int self) {
+        std::vector<StoreRecord> stores;
+        for (;;) {
+            for (size_t c = self; c < cores.size(); c += n) cores[c].sim->run_until(boundary);
+            barrier.wait();
+
+            if (self == 0) {
+                merged.clear();
+                finished = true;
+                for (size_t c = 0; c < cores.size(); ++c) {
+                    cores[c].sim->take_stores(stores);
+                    cores[c].published += (long)stores.size();
+                    for (const StoreRecord& s : stores) merged.push_back(SharedStore{s, (int)c});
+                    if (!cores[c].sim->done()) finished = false;
+                }
+                // Ja em ordem de nucleo e de commit: basta ordenar pelo ciclo
+                std::stable_sort(merged.begin(), merged.end(), [](const SharedStore& a, const SharedStore& b) {
+                    return a.store.cycle < b.store.cycle;
+                });
+                shared_stores += (long)merged.size();
+                ++quanta;
+                boundary += quantum;
+            }
+            barrier.wait();
+
+            for (size_t c = self; c < cores.size(); c += n) {
+                for (const SharedStore& s : merged) cores[c].sim->write_memory(s.store.address, s.store.value);
+            }
+            if (finished) return;
+        }
+    };
+
+    std::vector<std::thread> pool;
+    for (int t = 1; t < n; ++t) pool.emplace_back(worker, t);
+    worker(0);
+    for (std::thread& t : pool) t.join();
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    for (const Core& core : cores) {
+        if (core.sim->trace_failed()) return EXIT_FAILURE;
+    }
+
+    // --- Resultados (iguais com qualquer numero de threads) ---
+    std::cout << std::fixed << std::setprecision(4);
+    std::cout << "Nucleo |     Ciclos | Instrucoes |    IPC | STOREs | Trace" << std::endl;
+    long total_committed = 0;
+    long max_cycles = 0;
+    for (size_t c = 0; c < cores.size(); ++c) {
+        const SimStats& s = cores[c].sim->get_stats();
+        total_committed += s.committed;
+        max_cycles = std::max(max_cycles, s.cycles);
+        std::cout << std::setw(6) << c << " | " << std::setw(10) << s.cycles << " | " << std::setw(10) << s.committed
+                  << " | " << s.ipc() << " | " << std::setw(6) << cores[c].published << " | " << cores[c].trace
+                  << (s.finished ? "" : " (interrompido)") << std::endl;
+    }
+    std::cout << "Total: " << cores.size() << " nucleos, " << total_committed << " instrucoes em " << max_cycles
+              << " ciclos | IPC agregado: " << (max_cycles > 0 ? (double)total_committed / max_cycles : 0.0) << std::endl;
+    std::cout << "Quantum: " << quantum << " ciclos | sincronizacoes: " << quanta
+              << " | STOREs compartilhados: " << shared_stores << std::endl;
+
+    std::cout << "\nMemoria Compartilhada Final (Enderecos Modificados):" << std::endl;
+    for (auto const& cell : cores[0].sim->written_memory()) {
+        std::cout << "  [" << cell.first << "]: " << cell.second << std::endl;
+    }
+
+    std::cerr << std::fixed << std::setprecision(2) << total_committed << " instrucoes simuladas em " << seconds
+              << " s com " << n << " threads (" << (seconds > 0 ? total_committed / seconds / 1e6 : 0.0)
+              << " M instrucoes/s)" << std::endl;
+    return EXIT_SUCCESS;
+}
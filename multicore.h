@@ -0,0 +1,14 @@
+#ifndef MULTICORE_H
+#define MULTICORE_H
+
+// --- Simulacao Multinucleo (subcomando "multicore") ---
+// Um Simulator por trace, todos com a mesma configuracao e a mesma memoria
+// inicial, distribuidos entre threads. Os nucleos avancam em paralelo ate a
+// fronteira de cada quantum (em ciclos); ali os STOREs comprometidos por
+// todos sao ordenados por (ciclo, nucleo, ordem de commit) e aplicados na
+// memoria de cada nucleo. Um STORE so fica visivel aos outros nucleos no
+// quantum seguinte, e o resultado nao depende do numero de threads.
+// argv[0] e o proprio "multicore". Retorna o codigo de saida do processo.
+int run_multicore(int argc, char* argv[]);
+
+#endif // MULTICORE_H
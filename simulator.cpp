@@ -1,749 +1,1538 @@
-#include "simulator.h"
-#include <iomanip>
-#include <algorithm>
-#include <regex>
-#include <cstring>
-
-
-// --- Funcao Auxiliar para Mapeamento de Registradores ---
-std::string Simulator::get_register_name(int index) {
-    return "F" + std::to_string(index);
-}
-
-// --- Construtor ---
-Simulator::Simulator() 
-    : cycle(0), pc(0), simulation_complete(false), committed_inst_count(0) {
-
-    // Inicializa RS de ADD/SUB
-    for (int i = 1; i <= ADD_RS_COUNT; ++i) {
-        std::string name = "Add" + std::to_string(i);
-        add_rs[name] = RS_Entry();
-        add_rs[name].name = name;
-    }
-
-    // Inicializa RS de MUL/DIV
-    for (int i = 1; i <= MUL_RS_COUNT; ++i) {
-        std::string name = "Mult" + std::to_string(i);
-        mul_rs[name] = RS_Entry();
-        mul_rs[name].name = name;
-    }
-
-    // Inicializa Buffers de Load/Store (LS)
-    for (int i = 1; i <= LS_COUNT; ++i) {
-        std::string name = "L/S" + std::to_string(i);
-        ls_rs[name] = LS_Entry();
-        ls_rs[name].name = name;
-    }
-
-    // Inicializa Registradores F0 a F8 com valores iniciais
-    for (int i = 0; i <= 8; ++i) {
-        std::string reg_name = get_register_name(i);
-        reg_file[reg_name] = i + 10.0; 
-        reg_status[reg_name] = ""; 
-    }
-
-    // --- Valores iniciais específicos para teste ---
-    reg_file["F1"] = 100.0;   // Base address (para LOADs)
-    reg_file["F8"] = 2.0;     // Multiplicador
-
-    // --- Inicializa memória com dados reais ---
-    memory[132] = 10.0;   // endereço base 100 + offset 32
-    memory[136] = 20.0;   // endereço base 100 + offset 36
-    memory[1000] = 50.0;
-    memory[1004] = 60.0;
-    memory[1008] = 70.0;
-
-    std::cout << "[Inicialização] Registradores e memória configurados:\n";
-    std::cout << "  F1 = 100.0 (base)\n";
-    std::cout << "  F8 = 2.0\n";
-    std::cout << "  mem[132] = 10.0\n";
-    std::cout << "  mem[136] = 20.0\n";
-    std::cout << "  mem[1000] = 50.0\n";
-    std::cout << "  mem[1004] = 60.0\n";
-    std::cout << "  mem[1008] = 70.0\n";
-}
-
-
-// --- Carregamento de Instrucoes (Popula ID e Estado Inicial) ---
-
-bool Simulator::load_instructions(const std::string& filename) {
-    std::ifstream file(filename);
-    if (!file) {
-        std::cerr << "Erro ao abrir arquivo de instrucoes: " << filename << std::endl;
-        return false;
-    }
-    std::string line;
-    int id_counter = 0;
-    std::regex r_load(R"(^\s*(LOAD|STORE)\s+(\w+)\s*,\s*([+-]?\d+)\((\w+)\)\s*$)", std::regex::icase);
-    std::regex r_rtype(R"(^\s*(\w+)\s+(\w+)\s*,\s*(\w+)\s*,\s*(\w+)\s*$)", std::regex::icase);
-    while (std::getline(file, line)) {
-        if (line.empty()) continue;
-        auto posc = line.find('#');
-        if (posc != std::string::npos) line = line.substr(0, posc);
-        if (line.find_first_not_of(" \t\r\n") == std::string::npos) continue;
-        std::smatch m;
-        Instruction inst;
-        inst.id = id_counter++;
-        inst.state = NOT_ISSUED;
-        inst.value = 0.0;
-        inst.has_value = false;
-        inst.producer_tag = "";
-        inst.is_store = false;
-        if (std::regex_search(line, m, r_load)) {
-            inst.op = m[1];
-            std::string dest = m[2];
-            std::string offset = m[3];
-            std::string base = m[4];
-            inst.dest = dest;
-            inst.src1 = base; // base register
-            inst.src2 = offset; // store/load offset as string
-            if (strcasecmp(inst.op.c_str(), "STORE") == 0) inst.is_store = true;
-        } else if (std::regex_search(line, m, r_rtype)) {
-            inst.op = m[1];
-            inst.dest = m[2];
-            inst.src1 = m[3];
-            inst.src2 = m[4];
-        } else {
-            std::cerr << "Formato invalido de instrucao (ignorando): " << line << std::endl;
-            continue;
-        }
-        auto ensure_reg = [&](const std::string &r) {
-            if (r.empty()) return;
-            if (!reg_file.count(r)) { reg_file[r] = 0.0; reg_status[r] = ""; }
-        };
-        ensure_reg(inst.dest);
-        ensure_reg(inst.src1);
-        ensure_reg(inst.src2);
-        instruction_queue.push_back(inst);
-    }
-    std::cout << "Loaded " << instruction_queue.size() << " instructions from " << filename << std::endl;
-    return true;
-}
-
-
-// --- Loop Principal da Simulacao ---
-void Simulator::run() {
-    std::cout << "Iniciando Simulacao de Tomasulo com Committment..." << std::endl;
-    
-    // Imprime estado inicial
-    std::system("clear");
-    std::cout << "\n--- Estado Inicial (Ciclo 0) ---" << std::endl;
-    print_instruction_status();
-    print_state();
-    std::cout << "\nPressione ENTER para o proximo ciclo..." << std::endl;
-    std::cin.ignore(10000, '\n');
-
-    while (!simulation_complete) {
-        cycle++;
-        
-        std::system("clear"); 
-        std::cout << "\n--- CICLO " << cycle << " ---" << std::endl;
-
-        // Ordem dos estagios (COMMIT -> WB -> EXEC -> ISSUE)
-        commit(); // Novo Estagio
-        writeback();
-        execute();
-        issue();
-
-        print_instruction_status();
-        print_state();
-        
-
-        if (check_completion()) {
-            simulation_complete = true;
-        }
-
-        if (cycle > 500) { 
-            std::cout << "Simulacao interrompida (limite de ciclos atingido)." << std::endl;
-            break;
-        }
-        
-        std::cout << "\nPressione ENTER para o proximo ciclo..." << std::endl;
-        std::cin.ignore(10000, '\n'); 
-    }
-
-    std::cout << "\n--- Simulacao Concluida em " << cycle << " Ciclos ---" << std::endl;
-    print_final_registers();
-    print_memory_state();
-}
-
-
-// --- NOVO ESTÁGIO: Commit (Comprometimento) ---
-
-void Simulator::commit() {
-    // Commit in program order (instruction_queue as ROB)
-    while (committed_inst_count < (int)instruction_queue.size()) {
-        Instruction &inst = instruction_queue[committed_inst_count];
-        if (inst.state != WRITE_RESULT || !inst.has_value) break;
-
-        if (inst.is_store) {
-            // --- STORE ---
-            if (inst.address >= 0) {
-                memory[inst.address] = inst.value;
-                std::cout << "  [COMMIT] STORE ID" << inst.id
-                          << " mem[" << inst.address << "] = "
-                          << inst.value << std::endl;
-            } else {
-                std::cout << "  [COMMIT] STORE ID" << inst.id
-                          << " address not set." << std::endl;
-            }
-
-        } else {
-            // --- LOAD / ALU instruction ---
-            if (!inst.dest.empty()) {
-                if (reg_status[inst.dest] == inst.producer_tag) {
-                    reg_file[inst.dest] = inst.value;
-                    reg_status[inst.dest] = "";
-
-                    // ✅ NOVO: Broadcast para liberar dependentes ainda esperando
-                    for (auto &r : add_rs) {
-                        if (r.second.qj == inst.producer_tag) {
-                            r.second.vj = inst.value;
-                            r.second.qj = "";
-                        }
-                        if (r.second.qk == inst.producer_tag) {
-                            r.second.vk = inst.value;
-                            r.second.qk = "";
-                        }
-                    }
-                    for (auto &r : mul_rs) {
-                        if (r.second.qj == inst.producer_tag) {
-                            r.second.vj = inst.value;
-                            r.second.qj = "";
-                        }
-                        if (r.second.qk == inst.producer_tag) {
-                            r.second.vk = inst.value;
-                            r.second.qk = "";
-                        }
-                    }
-                    for (auto &r : ls_rs) {
-                        if (r.second.base_producer == inst.producer_tag) {
-                            r.second.base_value = inst.value;
-                            r.second.base_producer = "";
-                        }
-                        if (r.second.store_producer == inst.producer_tag) {
-                            r.second.store_value = inst.value;
-                            r.second.store_producer = "";
-                        }
-                    }
-
-                    std::cout << "  [COMMIT] WRITE " << inst.dest
-                              << " = " << inst.value << " (ID"
-                              << inst.id << ")" << std::endl;
-                } else {
-                    std::cout << "  [COMMIT] Skipped write to "
-                              << inst.dest
-                              << " because reg_status changed."
-                              << std::endl;
-                }
-            }
-        }
-
-        inst.state = COMMITTED;
-        inst.commit_cycle = cycle;
-        committed_inst_count++;
-    }
-}
-
-
-// --- Estagio de Emissao (Issue) - ATUALIZADO ---
-void Simulator::issue() {
-    if (pc >= instruction_queue.size()) {
-        std::cout << "  [ISSUE] Todas as instrucoes ja foram emitidas." << std::endl;
-        return;
-    }
-
-    Instruction& inst = instruction_queue[pc];
-
-    // --- 1. Aritmetica/Logica (ADD, SUB, MUL, DIV) ---
-    if (inst.op == "ADD" || inst.op == "SUB" || inst.op == "MUL" || inst.op == "DIV") {
-        std::map<std::string, RS_Entry>* target_rs_map = (inst.op == "ADD" || inst.op == "SUB") ? &add_rs : &mul_rs;
-        
-        std::string free_rs_name = "";
-        for (auto& pair : *target_rs_map) {
-            if (!pair.second.busy) {
-                free_rs_name = pair.first;
-                break;
-            }
-        }
-
-        if (free_rs_name.empty()) {
-            std::cout << "  [ISSUE] Parado: Perigo Estrutural em " << inst.op << " (Sem RS Livre)" << std::endl;
-            return; 
-        }
-
-        std::cout << "  [ISSUE] Emitindo (" << pc+1 << "/" << instruction_queue.size() << ") " << inst.op << " " << inst.dest << "," << inst.src1 << "," << inst.src2 << " para " << free_rs_name << std::endl;
-
-        // Preencher a RS
-        RS_Entry& rs = (*target_rs_map)[free_rs_name];
-        rs.busy = true;
-        rs.op = inst.op;
-        rs.instruction_id = inst.id; // NOVO: Rastreamento do ID
-        rs.cycles_remaining = -1; 
-        rs.ready_to_writeback = false;
-
-        // Preencher Vj/Qj e Vk/Qk (logica de renomeacao)
-        if (reg_status.count(inst.src1) && reg_status[inst.src1].empty()) { rs.vj = reg_file[inst.src1]; rs.qj = ""; } 
-        else if (reg_status.count(inst.src1)) { rs.qj = reg_status[inst.src1]; }
-
-        if (reg_status.count(inst.src2) && reg_status[inst.src2].empty()) { rs.vk = reg_file[inst.src2]; rs.qk = ""; } 
-        else if (reg_status.count(inst.src2)) { rs.qk = reg_status[inst.src2]; }
-
-        // Renomear o registrador de destino
-        reg_status[inst.dest] = free_rs_name;
-        
-        // NOVO: Atualizar estado da instrucao
-        inst.state = ISSUED;
-        inst.issue_cycle = cycle;
-        pc++;
-        
-    // --- 2. Load/Store (LOAD, STORE) ---
-    } else if (inst.op == "LOAD" || inst.op == "STORE") {
-        std::string free_ls_name = "";
-        for (auto& pair : ls_rs) {
-            if (!pair.second.busy) {
-                free_ls_name = pair.first;
-                break;
-            }
-        }
-
-        if (free_ls_name.empty()) {
-            std::cout << "  [ISSUE] Parado: Perigo Estrutural em " << inst.op << " (Sem L/S Buffer Livre)" << std::endl;
-            return; 
-        }
-
-        std::cout << "  [ISSUE] Emitindo (" << pc+1 << "/" << instruction_queue.size() << ") " << inst.op << " " << inst.dest << ", " << inst.src2 << "(" << inst.src1 << ") para " << free_ls_name << std::endl;
-
-        LS_Entry& ls = ls_rs[free_ls_name];
-        ls.busy = true;
-        ls.op = inst.op;
-        ls.dest_reg = inst.dest; 
-        ls.base_reg = inst.src1; 
-        ls.offset = std::stoi(inst.src2); 
-        ls.instruction_id = inst.id; // NOVO: Rastreamento do ID
-        ls.cycles_remaining = -1; 
-        ls.address_ready = false;
-        ls.ready_to_writeback = false;
-        ls.store_value = 0.0;
-        ls.store_producer = "";
-
-        // A. Base Register (SRC1)
-        if (reg_status.count(ls.base_reg) && reg_status[ls.base_reg].empty()) { ls.base_value = reg_file[ls.base_reg]; ls.base_producer = ""; } 
-        else if (reg_status.count(ls.base_reg)) { ls.base_producer = reg_status[ls.base_reg]; }
-
-        // B. Store Value (Dest Reg) - Apenas para STORE
-        if (ls.op == "STORE") {
-            std::string store_reg = inst.dest; 
-            if (reg_status.count(store_reg) && reg_status[store_reg].empty()) { ls.store_value = reg_file[store_reg]; ls.store_producer = ""; } 
-            else if (reg_status.count(store_reg)) { ls.store_producer = reg_status[store_reg]; }
-        }
-
-        // C. Renomeacao: Apenas LOAD renomeia o registrador de destino
-        if (ls.op == "LOAD") {
-            reg_status[ls.dest_reg] = free_ls_name;
-        }
-
-        // NOVO: Atualizar estado da instrucao
-        inst.state = ISSUED;
-        inst.issue_cycle = cycle;
-        pc++;
-    } else {
-        std::cout << "  [ISSUE] ERRO: OP desconhecido: " << inst.op << std::endl;
-        pc++;
-    }
-}
-
-// --- Estagio de Execucao (Execute) - ATUALIZADO ---
-void Simulator::execute() {
-    bool exec_activity = false;
-    
-    // --- 1. Processa RS de Aritmetica/Logica ---
-    auto process_rs_map = [&](std::map<std::string, RS_Entry>& rs_map) {
-        for (auto& pair : rs_map) {
-            RS_Entry& rs = pair.second;
-            if (!rs.busy || rs.ready_to_writeback) continue;
-
-            if (rs.qj.empty() && rs.qk.empty()) {
-                
-                // NOVO: 1. Iniciar execucao (se cycles_remaining == -1)
-                if (rs.cycles_remaining == -1) {
-                    int latency = (rs.op == "ADD" || rs.op == "SUB") ? ADD_LATENCY : ((rs.op == "MUL") ? MUL_LATENCY : DIV_LATENCY);
-                    rs.cycles_remaining = latency;
-                    instruction_queue[rs.instruction_id].state = EXECUTING; // Atualiza estado
-                    instruction_queue[rs.instruction_id].exec_start_cycle = cycle; // Atualiza tempo
-                    std::cout << "  [EXEC] Iniciando " << rs.name << " (" << rs.op << ") | Latencia: " << latency << std::endl;
-                    exec_activity = true;
-                }
-                
-                // 2. Decrementar contador
-                if (rs.cycles_remaining > 0) {
-                    rs.cycles_remaining--;
-                    exec_activity = true;
-                }
-
-                // NOVO: 3. Execucao concluida (cycles_remaining == 0)
-                if (rs.cycles_remaining == 0) {
-                    // Calculo do resultado
-                    if (rs.op == "ADD") rs.result = rs.vj + rs.vk;
-                    else if (rs.op == "SUB") rs.result = rs.vj - rs.vk;
-                    else if (rs.op == "MUL") rs.result = rs.vj * rs.vk;
-                    else if (rs.op == "DIV") rs.result = (rs.vk == 0) ? 0.0 : rs.vj / rs.vk;
-                    
-                    std::cout << "  [EXEC] Concluindo " << rs.name << " | Resultado: " << std::fixed << std::setprecision(4) << rs.result << std::endl;
-                    rs.ready_to_writeback = true;
-                    instruction_queue[rs.instruction_id].exec_end_cycle = cycle; // Atualiza tempo
-                    exec_activity = true;
-                }
-            }
-        }
-    };
-
-    process_rs_map(add_rs);
-    process_rs_map(mul_rs);
-
-
-    // --- 2. Processa Buffers de Load/Store (L/S) - ATUALIZADO ---
-    for (auto& pair : ls_rs) {
-        LS_Entry& ls = pair.second;
-        if (!ls.busy || ls.ready_to_writeback) continue;
-
-        Instruction& inst = instruction_queue[ls.instruction_id];
-
-        // A. Calculo de Endereco (Execucao do Endereco)
-        if (!ls.address_ready && ls.base_producer.empty()) {
-            ls.calculated_address = (long)(ls.base_value + ls.offset);
-            ls.address_ready = true;
-            ls.cycles_remaining = MEM_ACCESS_LATENCY; // Inicia a latencia de memoria
-            
-            // NOVO: Marca o inicio da execucao
-            inst.state = EXECUTING;
-            inst.exec_start_cycle = cycle; 
-            inst.address = ls.calculated_address; // Salva endereco na instrucao
-            
-            std::cout << "  [EXEC] Endereco de " << ls.name << " (" << ls.op << ") calculado: " << ls.calculated_address << std::endl;
-            exec_activity = true;
-        } 
-        
-        // B. Acesso a Memoria (Execucao de Memoria)
-        if (ls.address_ready) {
-            
-            // Perigo de Memoria (RAW Store-Load ou WAW/WAR)
-            LS_Entry* hazard_rs = find_address_hazard(ls.calculated_address, ls.name);
-            if (hazard_rs != nullptr) {
-                std::cout << "  [EXEC] " << ls.name << " (" << ls.op << ") PARADO: Perigo de Memoria com " << hazard_rs->name << std::endl;
-                continue; 
-            }
-
-            // Para STORE: Deve esperar o valor a ser armazenado (RAW no valor)
-            if (ls.op == "STORE" && !ls.store_producer.empty()) {
-                 std::cout << "  [EXEC] " << ls.name << " (STORE) PARADO: Esperando valor do produtor " << ls.store_producer << std::endl;
-                 continue; 
-            }
-            
-            // Decrementar contador de acesso a memoria
-            if (ls.cycles_remaining > 0) {
-                ls.cycles_remaining--;
-                exec_activity = true;
-            }
-
-            // Acesso a Memoria Concluido
-            if (ls.cycles_remaining == 0) {
-                // NOVO: Marca o fim da execucao
-                inst.exec_end_cycle = cycle; 
-
-                if (ls.op == "LOAD") {
-                    ls.result = memory.count(ls.calculated_address) ? memory[ls.calculated_address] : 0.0;
-                    std::cout << "  [EXEC] Concluindo " << ls.name << " (LOAD). Valor lido: " << ls.result << std::endl;
-                } else if (ls.op == "STORE") {
-                    std::cout << "  [EXEC] Concluindo " << ls.name << " (STORE). Pronto para escrever na memoria." << std::endl;
-                }
-                ls.ready_to_writeback = true;
-                exec_activity = true;
-            }
-        }
-    }
-
-
-    if (!exec_activity) {
-        std::cout << "  [EXEC] Nenhuma RS/LS iniciou ou avancou a execucao." << std::endl;
-    }
-}
-
-// --- Estagio de Escrita (Writeback) - ATUALIZADO E CORRIGIDO ---
-
-void Simulator::writeback() {
-    // 1️⃣ Percorre todas as estações de reserva (Add/Sub e Mul/Div)
-    std::vector<std::pair<std::string, RS_Entry*>> all_rs;
-    for (auto &p : add_rs) all_rs.push_back({p.first, &p.second});
-    for (auto &p : mul_rs) all_rs.push_back({p.first, &p.second});
-
-    // 2️⃣ Escolhe uma RS aritmética pronta para escrever (CDB)
-    for (auto &[name, rs] : all_rs) {
-        if (!rs->busy) continue;
-        if (!rs->ready_to_writeback) continue;
-
-        int inst_id = rs->instruction_id;
-        if (inst_id < 0 || inst_id >= (int)instruction_queue.size()) continue;
-        Instruction &inst = instruction_queue[inst_id];
-
-        double result = rs->result;
-        std::string tag = name;
-
-        // Guarda resultado (aguarda commit)
-        inst.value = result;
-        inst.has_value = true;
-        inst.producer_tag = tag;
-        inst.write_cycle = cycle;
-        inst.state = WRITE_RESULT;
-
-        std::cout << "  [WB] " << tag << " transmitiu resultado "
-                  << std::fixed << std::setprecision(4) << result
-                  << " (aguardando commit)" << std::endl;
-
-        // Broadcast (atualiza operandos dependentes)
-        for (auto &r : add_rs) {
-            if (r.second.qj == tag) { r.second.vj = result; r.second.qj = ""; }
-            if (r.second.qk == tag) { r.second.vk = result; r.second.qk = ""; }
-        }
-        for (auto &r : mul_rs) {
-            if (r.second.qj == tag) { r.second.vj = result; r.second.qj = ""; }
-            if (r.second.qk == tag) { r.second.vk = result; r.second.qk = ""; }
-        }
-        for (auto &r : ls_rs) {
-            if (r.second.base_producer == tag) {
-                r.second.base_value = result;
-                r.second.base_producer = "";
-            }
-            if (r.second.store_producer == tag) {
-                r.second.store_value = result;
-                r.second.store_producer = "";
-            }
-        }
-
-        // Libera estação
-        rs->busy = false;
-        rs->ready_to_writeback = false;
-        rs->instruction_id = -1;
-        rs->cycles_remaining = -1;
-        rs->result = 0.0;
-        break; // apenas um broadcast por ciclo
-    }
-
-    // 3️⃣ Agora processa as estações de LOAD/STORE
-    for (auto &pair : ls_rs) {
-        LS_Entry &ls = pair.second;
-        if (!ls.busy) continue;
-        if (!ls.ready_to_writeback) continue;
-
-        int inst_id = ls.instruction_id;
-        if (inst_id < 0 || inst_id >= (int)instruction_queue.size()) continue;
-        Instruction &inst = instruction_queue[inst_id];
-
-        if (ls.op == "LOAD") {
-            inst.value = ls.result;
-            inst.has_value = true;
-            inst.producer_tag = ls.name;
-            inst.write_cycle = cycle;
-            inst.state = WRITE_RESULT;
-            std::cout << "  [WB] " << ls.name << " (LOAD) leu valor "
-                      << std::fixed << std::setprecision(4) << ls.result
-                      << " e liberou buffer" << std::endl;
-        } else if (ls.op == "STORE") {
-            // STORE não escreve nada no registrador, só sinaliza commit futuro
-            inst.value = ls.store_value;
-            inst.has_value = true;
-            inst.producer_tag = ls.name;
-            inst.write_cycle = cycle;
-            inst.state = WRITE_RESULT;
-            std::cout << "  [WB] " << ls.name << " (STORE) pronto para commit" << std::endl;
-        }
-
-        // Libera a estação L/S
-        ls.busy = false;
-        ls.op = "";
-        ls.dest_reg = "";
-        ls.base_reg = "";
-        ls.base_producer = "";
-        ls.store_producer = "";
-        ls.address_ready = false;
-        ls.ready_to_writeback = false;
-        ls.cycles_remaining = -1;
-        ls.instruction_id = -1;
-        break; // um por ciclo
-    }
-}
-
-
-
-
-// --- Funcao de Checagem de Perigo de Memoria ---
-LS_Entry* Simulator::find_address_hazard(long address, const std::string& current_name) {
-    for (auto& pair : ls_rs) {
-        LS_Entry& hazard_rs = pair.second;
-        
-        if (!hazard_rs.busy || hazard_rs.name == current_name) continue;
-
-        if (hazard_rs.address_ready && hazard_rs.calculated_address == address) {
-            
-            // RAW (Store antes de Load no mesmo endereco)
-            if (hazard_rs.op == "STORE" && !hazard_rs.ready_to_writeback) {
-                 return &hazard_rs;
-            }
-        }
-    }
-    return nullptr;
-}
-
-// --- Funcoes de Checagem e Impressao (Atualizadas) ---
-
-bool Simulator::check_completion() {
-    return committed_inst_count == instruction_queue.size();
-}
-
-// NOVO: Imprime o status detalhado das instrucoes
-void Simulator::print_instruction_status() {
-    std::cout << "\n  --- STATUS DAS INSTRUCOES (ROB Implicito) ---" << std::endl;
-    std::cout << "    " << std::setw(3) << "ID" << " | " << std::setw(4) << "OP" << " | " << std::setw(12) << "Estado" << " | "
-              << std::setw(4) << "Issue" << " | " << std::setw(4) << "ExecS" << " | " << std::setw(4) << "ExecE" << " | " 
-              << std::setw(4) << "Write" << " | " << std::setw(4) << "Commit" << std::endl;
-    std::cout << "    " << std::string(60, '-') << std::endl;
-
-    auto state_to_string = [](InstrState state) -> std::string {
-        switch (state) {
-            case NOT_ISSUED: return "NOT_ISSUED";
-            case ISSUED: return "ISSUED";
-            case EXECUTING: return "EXECUTING";
-            case WRITE_RESULT: return "WRITE_RESULT";
-            case COMMITTED: return "COMMITTED";
-            default: return "UNKNOWN";
-        }
-    };
-
-    for (const auto& inst : instruction_queue) {
-        std::string issue_c = inst.issue_cycle > 0 ? std::to_string(inst.issue_cycle) : "-";
-        std::string execs_c = inst.exec_start_cycle > 0 ? std::to_string(inst.exec_start_cycle) : "-";
-        std::string exece_c = inst.exec_end_cycle > 0 ? std::to_string(inst.exec_end_cycle) : "-";
-        std::string write_c = inst.write_cycle > 0 ? std::to_string(inst.write_cycle) : "-";
-        std::string commit_c = inst.commit_cycle > 0 ? std::to_string(inst.commit_cycle) : "-";
-
-        std::cout << "    " << std::setw(3) << inst.id << " | " << std::setw(4) << inst.op << " | " << std::setw(12) << state_to_string(inst.state) << " | "
-                  << std::setw(4) << issue_c << " | " << std::setw(4) << execs_c << " | " << std::setw(4) << exece_c << " | "
-                  << std::setw(4) << write_c << " | " << std::setw(4) << commit_c << std::endl;
-    }
-}
-
-
-void Simulator::print_state() {
-    std::cout << std::fixed << std::setprecision(4); 
-
-    // --- Tabela de Estacoes de Reserva Aritmeticas ---
-    std::cout << "\n  --- Estacoes de Reserva (Aritmeticas) ---" << std::endl;
-    std::cout << "    " << std::setw(6) << "Nome" << " | " << std::setw(4) << "Busy" << " | " << std::setw(4) << "Op" << " | " << std::setw(10) << "Vj" << " | " << std::setw(10) << "Vk" << " | " << std::setw(6) << "Qj" << " | " << std::setw(6) << "Qk" << " | " << "Ciclos/ID" << std::endl;
-    std::cout << "    " << std::string(75, '-') << std::endl;
-    
-    auto print_rs_map = [&](std::map<std::string, RS_Entry>& rs_map) {
-        for (auto const& pair : rs_map) {
-            const std::string& name = pair.first;
-            const RS_Entry& rs = pair.second;
-            
-            std::string vj_str = "";
-            std::string vk_str = "";
-            if (rs.busy) {
-                if (rs.qj.empty()) vj_str = std::to_string(rs.vj); else vj_str = " ";
-                if (rs.qk.empty()) vk_str = std::to_string(rs.vk); else vk_str = " ";
-            }
-
-            std::string cycles_str = "-";
-            if (!rs.busy) cycles_str = "-";
-            else if (rs.ready_to_writeback) cycles_str = "WB/ID"+std::to_string(rs.instruction_id);
-            else if (rs.cycles_remaining >= 0) cycles_str = std::to_string(rs.cycles_remaining) + "/ID"+std::to_string(rs.instruction_id);
-            else if (rs.cycles_remaining == -1 && (rs.qj.empty() && rs.qk.empty())) cycles_str = "RTS/ID"+std::to_string(rs.instruction_id); 
-
-            std::string busy_str = rs.busy ? "Sim" : "Nao";
-
-            std::cout << "    " << std::setw(6) << name << " | " << std::setw(4) << busy_str << " | " << std::setw(4) << rs.op << " | "
-                      << std::setw(10) << vj_str << " | "
-                      << std::setw(10) << vk_str << " | "
-                      << std::setw(6) << rs.qj << " | " << std::setw(6) << rs.qk << " | "
-                      << std::setw(10) << cycles_str << std::endl;
-        }
-    };
-    
-    print_rs_map(add_rs);
-    print_rs_map(mul_rs);
-    
-    // --- Tabela de Buffers de Load/Store (Memoria) ---
-    std::cout << "\n  --- Buffers de Load/Store (Memoria) ---" << std::endl;
-    std::cout << "    " << std::setw(6) << "Nome" << " | " << std::setw(4) << "Op" << " | " << std::setw(6) << "FDest" << " | " << std::setw(6) << "End_Calc" << " | " << std::setw(6) << "QBase" << " | " << std::setw(6) << "QStore" << " | " << "Ciclos/ID" << std::endl;
-    std::cout << "    " << std::string(75, '-') << std::endl;
-    
-    for (auto const& pair : ls_rs) {
-        const std::string& name = pair.first;
-        const LS_Entry& ls = pair.second;
-        
-        if (!ls.busy) {
-            std::cout << "    " << std::setw(6) << name << " | " << std::setw(4) << "Nao" << " | " << std::setw(6) << "" << " | " << std::setw(6) << "-" << " | " << std::setw(6) << "" << " | " << std::setw(6) << "" << " | " << std::setw(10) << "-" << std::endl;
-            continue;
-        }
-
-        std::string op_str = ls.op;
-        std::string reg_str = ls.dest_reg; 
-        std::string addr_str = (ls.calculated_address != -1) ? std::to_string(ls.calculated_address) : "Calc";
-        
-        std::string cycles_str = "Wait/ID"+std::to_string(ls.instruction_id);
-        if (ls.ready_to_writeback) cycles_str = (ls.op == "LOAD") ? "WB/ID"+std::to_string(ls.instruction_id) : "Done/ID"+std::to_string(ls.instruction_id);
-        else if (ls.cycles_remaining >= 0) cycles_str = std::to_string(ls.cycles_remaining) + "/ID"+std::to_string(ls.instruction_id);
-        else if (ls.address_ready) cycles_str = "MemWait/ID"+std::to_string(ls.instruction_id);
-        else if (ls.base_producer.empty() && ls.op == "STORE" && ls.store_producer.empty()) cycles_str = "RTS/ID"+std::to_string(ls.instruction_id);
-        else if (ls.base_producer.empty() && ls.op == "LOAD") cycles_str = "RTS/ID"+std::to_string(ls.instruction_id);
-
-
-        std::cout << "    " << std::setw(6) << name << " | " << std::setw(4) << op_str << " | " << std::setw(6) << reg_str << " | " 
-                  << std::setw(6) << addr_str << " | " << std::setw(6) << ls.base_producer << " | " 
-                  << std::setw(6) << (ls.op == "STORE" ? ls.store_producer : "") << " | " << std::setw(10) << cycles_str << std::endl;
-    }
-
-
-    // --- Tabela de Status dos Registradores (Qi) ---
-    std::cout << "\n  --- Status dos Registradores (Qi) ---" << std::endl;
-    std::cout << "   ";
-    for (int i = 0; i <= 8; ++i) {
-        std::string reg_name = get_register_name(i);
-        std::cout << " | " << std::setw(8) << reg_name;
-    }
-    std::cout << " |" << std::endl;
-    std::cout << "   ";
-    for (int i = 0; i <= 8; ++i) {
-        std::string reg_name = get_register_name(i);
-        const std::string& status = reg_status[reg_name];
-        std::cout << " | " << std::setw(8) << (status.empty() ? "Pronto" : status);
-    }
-    std::cout << " |" << std::endl;
-
-    // --- Fila de Instrucoes (PC) ---
-    if (pc < instruction_queue.size()) {
-        const Instruction& next_inst = instruction_queue[pc];
-        std::cout << "\n  --- Fila de Instrucoes (PC=" << pc+1 << "/" << instruction_queue.size() << ") ---" << std::endl;
-        std::cout << "    Proxima a emitir (ID " << next_inst.id << "): " << next_inst.op << " " << next_inst.dest << (next_inst.op == "LOAD" || next_inst.op == "STORE" ? ", " + next_inst.src2 + "(" + next_inst.src1 + ")" : ", " + next_inst.src1 + "," + next_inst.src2) << std::endl;
-    } else {
-        std::cout << "\n  --- Fila de Instrucoes ---" << std::endl;
-        std::cout << "    Todas as instrucoes foram emitidas." << std::endl;
-    }
-}
-
-void Simulator::print_final_registers() {
-    std::cout << "\nValores Finais dos Registradores:" << std::endl;
-    std::cout << std::fixed << std::setprecision(4);
-    for (int i = 0; i <= 8; ++i) {
-        std::string reg_name = get_register_name(i);
-        std::cout << "  " << reg_name << ": " << reg_file[reg_name] << std::endl;
-    }
-}
-
-void Simulator::print_memory_state() {
-    std::cout << "\nConteudo Final da Memoria (Enderecos Modificados):" << std::endl;
-    std::cout << std::fixed << std::setprecision(4);
-    for (auto const& pair : memory) {
-        std::cout << "  [" << pair.first << "]: " << pair.second << std::endl;
-    }
+#include "simulator.h"
+#include "terminal.h"
+#include <iomanip>
+#include <algorithm>
+#include <cstring>
+#include <climits>
+
+
+// --- Funcao Auxiliar para Mapeamento de Registradores ---
+std::string Simulator::get_register_name(int index) {
+    if (index >= R_REG_BASE) return "R" + std::to_string(index - R_REG_BASE);
+    return "F" + std::to_string(index);
+}
+
+// Trace e configuracao nao combinam: reporta o maior registrador fora de cada banco
+bool Simulator::fits_register_banks(const SimConfig& config, int f_used, int r_used, const std::string& where) {
+    bool ok = true;
+    if (f_used > config.f_regs) {
+        std::cerr << where << ": usa F" << (f_used - 1) << ", fora do banco de registradores (f_regs = "
+                  << config.f_regs << ")" << std::endl;
+        ok = false;
+    }
+    if (r_used > config.r_regs) {
+        std::cerr << where << ": usa R" << (r_used - 1) << ", fora do banco de registradores (r_regs = "
+                  << config.r_regs << ")" << std::endl;
+        ok = false;
+    }
+    return ok;
+}
+
+// --- Nome de exibicao de uma tag ("Add1", "Mult2", "L/S1"; "" = sem produtor) ---
+std::string Simulator::tag_name(Tag tag) const {
+    return station_name(tag, config.add_rs, rs.size());
+}
+
+// Latencia de cada operacao na maquina configurada
+int Simulator::op_latency(OpCode op) const {
+    switch (op) {
+        case OP_ADD: case OP_SUB: return config.add_latency;
+        case OP_MUL: return config.mul_latency;
+        case OP_DIV: return config.div_latency;
+        default: return config.mem_latency;
+    }
+}
+
+// --- Construtor ---
+Simulator::Simulator(const SimConfig& config, RunMode mode) 
+    : config(config), mode(mode), verbose(mode == MODE_INTERACTIVE), print_cycles(mode == MODE_INTERACTIVE),
+      cycle(0), pc(0), simulation_complete(false), halted(false), started(false),
+      committed_inst_count(0), observer(nullptr), pause_cycle(0), warmup_end(0),
+      fetched(0), source_done(true), window_elastic(false), roi_seq(-1), trace_bytes(0), bad_trace(false),
+      issue_progress(false), issue_stall(nullptr), cycle_limit(0),
+      checkpoint_every(0), next_checkpoint(0), log_events(false), log_summary(false), recording_stores(false) {
+
+    // Inicializa RS (Add1..AddN seguidas de Mult1..MultN) e Buffers de Load/Store (LS)
+    rs.resize(config.add_rs + config.mul_rs);
+    ls.resize(config.ls_buffers);
+    waiters.assign(rs.size() + ls.size() + 1, std::vector<Waiter>());
+    stats.stations.assign(rs.size() + ls.size(), StationCounters());
+    rob.configure(config.rob_size);
+    caches.configure(config.l1, config.l2, config.mem_latency);
+
+    // No modo interativo os eventos vao para a tela no fim de cada ciclo
+    if (verbose && config.log_level != LOG_OFF) {
+        event_log.open_screen(log_header());
+        start_log();
+    }
+
+    // Inicializa Registradores com os valores da configuracao (demais comecam em 0)
+    reg_file.assign(NUM_REGS, 0.0);
+    reg_status.assign(NUM_REGS, NO_TAG);
+    reg_producer.assign(NUM_REGS, -1);
+    for (auto const& reg : config.registers) {
+        reg_file[reg.first] = reg.second;
+    }
+
+    if (!verbose) return;
+    std::cout << "[Inicialização] Registradores configurados:\n";
+    for (auto const& reg : config.registers) {
+        std::cout << "  " << get_register_name(reg.first) << " = " << reg.second << "\n";
+    }
+}
+
+
+// --- Memoria Inicial: imagem (se houver) seguida das celulas da configuracao ---
+bool Simulator::init_memory() {
+    if (!config.mem_image.empty()) {
+        if (!memory.load_image(config.mem_image, config.mem_base)) return false;
+        if (verbose) std::cout << "[Inicialização] Imagem de memoria " << config.mem_image
+                               << " mapeada a partir do endereco " << config.mem_base << std::endl;
+    }
+
+    std::map<long, double> cells = config.initial_memory();
+    if (verbose && !cells.empty()) std::cout << "[Inicialização] Memória configurada:\n";
+    for (auto const& cell : cells) {
+        memory.write(cell.first, cell.second);
+        if (verbose) std::cout << "  mem[" << cell.first << "] = " << cell.second << "\n";
+    }
+    return true;
+}
+
+
+// --- Carregamento de Instrucoes (Popula ID e Estado Inicial) ---
+
+bool Simulator::load_instructions(const std::string& filename) {
+    std::unique_ptr<InstructionSource> parser = open_trace(filename);
+    if (!parser) return false;
+    return load_all(*parser, filename);
+}
+
+bool Simulator::load_text(const std::string& text, const std::string& name) {
+    TraceParser parser;
+    parser.open_text(text, name);
+    return load_all(parser, name);
+}
+
+// Decodifica a fonte inteira para a janela (programa todo carregado)
+bool Simulator::load_all(InstructionSource& parser, const std::string& name) {
+    // Total do trace binario ou estimativa de ~16 bytes por linha, para evitar realocacoes
+    long expected = parser.count() >= 0 ? parser.count() : (long)(parser.size_bytes() / 16);
+    inst_window.reserve(inst_window.size() + expected);
+
+    trace_name = name;
+    DecodedInst code;
+    while (parser.next(code)) {
+        if (!check_fetched(code, (long)inst_window.size())) {
+            inst_window.clear();
+            return false;
+        }
+        Instruction inst;
+        static_cast<DecodedInst&>(inst) = code;
+        // Resolve a latencia uma unica vez
+        inst.latency = (uint16_t)op_latency(inst.op);
+        inst.id = (long)inst_window.size();
+        inst.state = NOT_ISSUED;
+        inst_window.push_back(inst);
+    }
+    fetched = (long)inst_window.size();
+    source_done = true;
+    roi_seq = parser.roi_start();
+    if (verbose) std::cout << "Loaded " << inst_window.size() << " instructions from " << name << std::endl;
+    return true;
+}
+
+
+// --- Modo Streaming: instrucoes buscadas sob demanda em uma janela fixa ---
+// Com window_size 0 a janela e elastica (cresce com as instrucoes em voo), o
+// que equivale a ter o programa inteiro carregado.
+bool Simulator::open_stream(const std::string& filename, int window_size) {
+    std::unique_ptr<InstructionSource> parser = open_trace(filename);
+    if (!parser) return false;
+    // Trace binario: os registros ja estao mapeados e os bancos sao conferidos
+    // agora; em texto, cada instrucao e conferida ao ser lida (check_fetched)
+    if (BinaryTrace* binary = dynamic_cast<BinaryTrace*>(parser.get())) {
+        int f_used = 0, r_used = 0;
+        registers_used(binary->records(), (size_t)binary->count(), f_used, r_used);
+        if (!fits_register_banks(config, f_used, r_used, filename)) return false;
+    }
+    trace_name = filename;
+    window_elastic = (window_size < 1);
+
+    inst_window.assign(window_elastic ? 64 : window_size, Instruction());
+    trace_bytes = parser->size_bytes();
+    source = std::move(parser);
+    fetched = 0;
+    source_done = false;
+    if (verbose) {
+        if (window_elastic) std::cout << "Streaming de " << filename << " (janela elastica)" << std::endl;
+        else std::cout << "Streaming de " << filename << " (janela de " << window_size << " instrucoes)" << std::endl;
+    }
+    return true;
+}
+
+// Traz a proxima instrucao da fonte para a janela. Falha se a fonte acabou
+// ou se a janela esta cheia de instrucoes ainda nao comprometidas.
+bool Simulator::fetch_next() {
+    if (source_done) return false;
+    if (fetched - committed_inst_count >= (long)inst_window.size()) {
+        if (!window_elastic) return false;
+        grow_window();
+    }
+
+    DecodedInst code;
+    if (!source->next(code)) {
+        source_done = true;
+        source.reset();
+        return false;
+    }
+    if (!check_fetched(code, fetched)) return false;
+    store_fetched(code);
+    return true;
+}
+
+// Instrucao 'seq' do trace com registrador fora dos bancos: o trace nao
+// combina com a configuracao e a simulacao para (sem resumo)
+bool Simulator::check_fetched(const DecodedInst& code, long seq) {
+    if (config.instruction_in_banks(code)) return true;
+    int f_used = 0, r_used = 0;
+    registers_used(&code, 1, f_used, r_used);
+    fits_register_banks(config, f_used, r_used, trace_name + ": instrucao " + std::to_string(seq));
+    bad_trace = true;
+    halted = true;
+    source_done = true;
+    source.reset();
+    return false;
+}
+
+// Ocupa o slot da janela da instrucao de sequencia 'fetched'
+void Simulator::store_fetched(const DecodedInst& code) {
+    Instruction& inst = inst_at(fetched);
+    inst = Instruction();
+    static_cast<DecodedInst&>(inst) = code;
+    inst.latency = (uint16_t)op_latency(inst.op);
+    inst.id = fetched++;
+}
+
+// Dobra a janela elastica, reposicionando as instrucoes ainda residentes
+void Simulator::grow_window() {
+    std::vector<Instruction> bigger(inst_window.size() * 2);
+    long first = std::max(0L, fetched - (long)inst_window.size());
+    for (long seq = first; seq < fetched; ++seq) {
+        bigger[seq % bigger.size()] = inst_at(seq);
+    }
+    inst_window.swap(bigger);
+}
+
+// --- Programa ja decodificado e compartilhado (somente leitura) ---
+// Usado pela varredura: o trace e lido uma unica vez e cada simulador so
+// guarda a propria janela, que cresce conforme o numero de instrucoes em voo,
+// entao o resultado e identico ao do programa carregado inteiro.
+bool Simulator::open_program(std::shared_ptr<const Program> program) {
+    if (!fits_register_banks(config, program->f_regs, program->r_regs, program->name)) return false;
+    trace_name = program->name;
+    inst_window.assign(64, Instruction());
+    source.reset(new ProgramSource(std::move(program)));
+    fetched = 0;
+    source_done = false;
+    window_elastic = true;
+    return true;
+}
+
+// --- Saida das linhas de tempo (uma por instrucao, gravada no commit) ---
+bool Simulator::open_timing_output(const std::string& filename) {
+    timing_out.open(filename);
+    if (!timing_out) {
+        std::cerr << "Erro ao criar arquivo de tempos: " << filename << std::endl;
+        return false;
+    }
+    timing_out << "id,op,issue,exec_start,exec_end,write,commit\n";
+    return true;
+}
+
+void Simulator::write_timing_row(const Instruction& inst) {
+    timing_out << inst.id << ',' << op_name(inst.op) << ',' << inst.issue_cycle << ','
+               << inst.exec_start_cycle << ',' << inst.exec_end_cycle << ','
+               << inst.write_cycle << ',' << inst.commit_cycle << '\n';
+}
+
+// --- Loop Principal da Simulacao ---
+void Simulator::run() {
+    if (!started) begin();
+    if (bad_trace) return;
+    if (verbose && TerminalView::available()) {
+        run_terminal();
+        if (!bad_trace) print_summary();
+        return;
+    }
+
+    if (verbose) {
+        std::cout << "Iniciando Simulacao de Tomasulo com Committment..." << std::endl;
+
+        // Imprime estado inicial
+        std::system("clear");
+        std::cout << "\n--- Estado Inicial (Ciclo " << cycle << ") ---" << std::endl;
+        print_instruction_status(std::cout, std::max(0L, fetched - (long)inst_window.size()), fetched);
+        print_state(std::cout);
+        std::cout << "\nPressione ENTER para o proximo ciclo..." << std::endl;
+        std::cin.ignore(10000, '\n');
+    }
+
+    for (;;) {
+        bool more = step();
+        if (halted) break;  // limite de ciclos ou travamento: sem pausa
+        if (verbose) {
+            std::cout << "\nPressione ENTER para o proximo ciclo..." << std::endl;
+            std::cin.ignore(10000, '\n'); 
+        }
+        if (!more) break;
+    }
+
+    if (mode == MODE_SILENT || bad_trace) return;
+    print_summary();
+}
+
+// --- Execucao Passo a Passo ---
+
+bool Simulator::step() {
+    return observer != nullptr ? step_impl<true>() : step_impl<false>();
+}
+
+bool Simulator::run_until(long target_cycle) {
+    pause_cycle = target_cycle;
+    while (cycle < target_cycle && step()) {}
+    pause_cycle = 0;
+    return !done();
+}
+
+bool Simulator::run_to_completion() {
+    while (step()) {}
+    return simulation_complete;
+}
+
+const Instruction* Simulator::instruction(long seq) const {
+    if (seq < 0 || seq >= fetched || inst_window.empty()) return nullptr;
+    const Instruction& inst = inst_at(seq);
+    return inst.id == seq ? &inst : nullptr;
+}
+
+// Antes do primeiro ciclo: fast-forward, se pedido, e o limite de ciclos,
+// que conta a partir do inicio (ou do checkpoint restaurado)
+void Simulator::begin() {
+    started = true;
+    if (config.fast_forward != 0 && cycle == 0 && committed_inst_count == 0) fast_forward();
+    if (config.warmup > 0) warmup_end = committed_inst_count + config.warmup;
+    cycle_limit = config.max_cycles > 0 ? stats.start_cycle + config.max_cycles : 0;
+    if (checkpoint_every > 0) next_checkpoint = (cycle / checkpoint_every + 1) * checkpoint_every;
+}
+
+void Simulator::update_stats() {
+    stats.cycles = cycle;
+    stats.committed = committed_inst_count - stats.fast_forwarded;
+    stats.finished = simulation_complete;
+    stats.l1 = caches.l1.stats;
+    stats.l2 = caches.l2.stats;
+}
+
+// Fim da simulacao (completa ou interrompida): saidas gravadas uma unica vez
+void Simulator::finish() {
+    if (counters_out.is_open()) write_counters_json(counters_out);
+    event_log.close();
+}
+
+template <bool Observed>
+bool Simulator::step_impl() {
+    if (done()) return false;
+    if (!started) begin();
+    cycle++;
+    
+    if (print_cycles) std::system("clear");
+    if (log_events) event_log.push(event(EV_CYCLE));
+    long committed_before = committed_inst_count;
+    long issued_before = stats.issued;
+    long broadcasts_before = stats.cdb_broadcasts;
+
+    // Ordem dos estagios (COMMIT -> WB -> EXEC -> ISSUE)
+    commit<Observed>(); // Novo Estagio
+    writeback<Observed>();
+    execute<Observed>();
+    issue<Observed>();
+
+    sample_counters(1);
+
+    if (log_summary) {
+        LogEvent e = event(EV_SUMMARY);
+        e.a = rob.occupancy();
+        e.b = committed_inst_count - committed_before;
+        e.c = (int32_t)(stats.issued - issued_before);
+        e.d = (int32_t)(stats.cdb_broadcasts - broadcasts_before);
+        event_log.push(e);
+    }
+
+    if (print_cycles) {
+        std::vector<std::string> lines;
+        event_log.render_pending(lines);
+        for (const std::string& line : lines) std::cout << line << '\n';
+        // Linhas ainda residentes na janela (todas, quando o programa foi carregado inteiro)
+        print_instruction_status(std::cout, std::max(0L, fetched - (long)inst_window.size()), fetched);
+        print_state(std::cout);
+    }
+
+    // Trace com registrador fora dos bancos (check_fetched): para sem pular
+    // ciclos, checkpoints nem resumo
+    if (bad_trace) return false;
+
+    if (check_completion()) {
+        simulation_complete = true;
+    }
+
+    if (cycle_limit > 0 && cycle > cycle_limit) { 
+        if (mode != MODE_SILENT) std::cout << "Simulacao interrompida (limite de ciclos atingido)." << std::endl;
+        halted = true;
+    }
+
+    // Fora do modo interativo, pula direto para o proximo ciclo com evento
+    else if (!verbose && !simulation_complete && config.cycle_skip && !skip_idle_cycles()) {
+        if (mode != MODE_SILENT) std::cout << "Simulacao travada: nenhuma instrucao pode avancar (ciclo " << cycle << ")." << std::endl;
+        halted = true;
+    }
+
+    else if (next_checkpoint > 0 && cycle >= next_checkpoint && !simulation_complete) {
+        std::string name = checkpoint_prefix + "." + std::to_string(cycle) + ".ckpt";
+        if (!save_checkpoint(name)) {
+            next_checkpoint = 0;
+        } else {
+            if (mode != MODE_SILENT) std::cout << "Checkpoint gravado: " << name << std::endl;
+            next_checkpoint += checkpoint_every;
+        }
+    }
+
+    if (warmup_end > 0 && committed_inst_count >= warmup_end) end_warmup();
+
+    update_stats();
+    if (done()) {
+        finish();
+        return false;
+    }
+    return true;
+}
+
+
+// --- Salto de Ciclos Ociosos ---
+// Se no fim do ciclo nada pode mudar no proximo (nenhum commit, writeback,
+// inicio de execucao, calculo de endereco ou issue pendente), os ciclos
+// seguintes so decrementam as latencias em andamento. Calcula quantos ciclos
+// faltam para a proxima conclusao e avanca ate o ciclo anterior a ela,
+// aplicando o efeito acumulado dos ciclos pulados nos contadores e nas
+// estatisticas, de modo que todos os tempos continuam exatos.
+// Retorna false se nenhum evento futuro existe (simulacao travada, sem limite).
+bool Simulator::skip_idle_cycles() {
+    if (issue_progress) return true;
+    if (!rob.empty() && rob.at(rob.head).ready) return true;
+
+    const long NO_EVENT = LONG_MAX;
+    long gap = NO_EVENT;
+    for (int i = 0; i < rs.size(); ++i) {
+        if (!rs.busy[i]) continue;
+        if (rs.ready_to_writeback[i]) return true;
+        if (rs.qj[i] != NO_TAG || rs.qk[i] != NO_TAG) continue;   // espera o CDB
+        if (rs.cycles_remaining[i] <= 0) return true;              // inicia no proximo ciclo
+        gap = std::min(gap, (long)rs.cycles_remaining[i]);
+    }
+    for (int i = 0; i < ls.size(); ++i) {
+        if (!ls.busy[i]) continue;
+        if (ls.ready_to_writeback[i]) return true;
+        if (!ls.address_ready[i]) {
+            if (ls.base_producer[i] == NO_TAG) return true;        // calcula o endereco
+            continue;
+        }
+        // Parados pela ordem de memoria ou pelo valor do STORE so andam depois de outro evento
+        if (ls.op[i] == OP_LOAD && load_blocked(i)) continue;
+        if (ls.op[i] == OP_STORE && ls.store_producer[i] != NO_TAG) continue;
+        if (ls.cycles_remaining[i] <= 0) return true;
+        gap = std::min(gap, (long)ls.cycles_remaining[i]);
+    }
+
+    long skip;
+    if (gap == NO_EVENT) {
+        if (cycle_limit == 0) return false;
+        skip = cycle_limit - cycle;
+    } else {
+        skip = gap - 1;
+    }
+    if (cycle_limit > 0) skip = std::min(skip, cycle_limit - cycle);
+    if (next_checkpoint > 0) skip = std::min(skip, next_checkpoint - cycle);   // para no checkpoint
+    if (pause_cycle > 0) skip = std::min(skip, pause_cycle - cycle);            // e no alvo de run_until
+    if (skip <= 0) return true;
+
+    for (int i = 0; i < rs.size(); ++i) {
+        if (rs.busy[i] && !rs.ready_to_writeback[i] && rs.qj[i] == NO_TAG && rs.qk[i] == NO_TAG) {
+            rs.cycles_remaining[i] -= (int)skip;
+        }
+    }
+    for (int i = 0; i < ls.size(); ++i) {
+        if (!ls.busy[i] || !ls.address_ready[i]) continue;
+        if (ls.op[i] == OP_LOAD && load_blocked(i)) continue;
+        if (ls.op[i] == OP_STORE && ls.store_producer[i] != NO_TAG) continue;
+        ls.cycles_remaining[i] -= (int)skip;
+    }
+    // Ciclos pulados: mesmo estado do fim deste ciclo, sem commit
+    sample_counters(skip);
+    stats.cpi[blame_rob_head()] += skip;
+    if (issue_stall != nullptr) *issue_stall += skip;
+    if (log_events || log_summary) {
+        LogEvent e = event(EV_SKIP);
+        e.cycle = cycle + 1;
+        e.a = cycle + skip;
+        event_log.push(e);
+    }
+    cycle += skip;
+    return true;
+}
+
+
+// --- Contadores de Desempenho ---
+
+const char* cpi_category_name(CpiCategory category) {
+    switch (category) {
+        case CPI_BASE: return "base";
+        case CPI_FRONTEND: return "frontend";
+        case CPI_DEPENDENCY: return "dependency";
+        case CPI_MEM_HAZARD: return "memory_hazard";
+        case CPI_STORE_DATA: return "store_data";
+        case CPI_EXEC_ADD: return "exec_add";
+        case CPI_EXEC_MUL: return "exec_mul";
+        case CPI_EXEC_DIV: return "exec_div";
+        case CPI_EXEC_MEM: return "exec_mem";
+        case CPI_CDB: return "cdb_wait";
+        default: return "";
+    }
+}
+
+// Motivo pelo qual a instrucao na cabeca do ROB ainda nao pode comprometer
+CpiCategory Simulator::blame_rob_head() {
+    if (rob.empty()) return CPI_FRONTEND;
+    if (rob.at(rob.head).ready) return CPI_BASE;
+    long head = rob.head;
+    OpCode op = inst_at(head).op;
+
+    if (op == OP_LOAD || op == OP_STORE) {
+        for (int i = 0; i < ls.size(); ++i) {
+            if (!ls.busy[i] || ls.instruction_id[i] != head) continue;
+            if (ls.ready_to_writeback[i]) return CPI_CDB;
+            if (!ls.address_ready[i]) return CPI_DEPENDENCY;
+            if (op == OP_LOAD && load_blocked(i)) return CPI_MEM_HAZARD;
+            if (op == OP_STORE && ls.store_producer[i] != NO_TAG) return CPI_STORE_DATA;
+            return CPI_EXEC_MEM;
+        }
+    } else {
+        for (int i = 0; i < rs.size(); ++i) {
+            if (!rs.busy[i] || rs.instruction_id[i] != head) continue;
+            if (rs.ready_to_writeback[i]) return CPI_CDB;
+            if (rs.qj[i] != NO_TAG || rs.qk[i] != NO_TAG || rs.cycles_remaining[i] < 0) return CPI_DEPENDENCY;
+            if (op == OP_DIV) return CPI_EXEC_DIV;
+            if (op == OP_MUL) return CPI_EXEC_MUL;
+            return CPI_EXEC_ADD;
+        }
+    }
+    return CPI_FRONTEND;
+}
+
+// Amostra o estado do fim do ciclo; 'weight' > 1 conta ciclos pulados identicos
+void Simulator::sample_counters(long weight) {
+    stats.rob_occupancy_sum += rob.occupancy() * weight;
+    stats.rob_occupancy_max = std::max(stats.rob_occupancy_max, rob.occupancy());
+
+    for (int i = 0; i < rs.size(); ++i) {
+        if (!rs.busy[i]) continue;
+        StationCounters& c = stats.stations[i];
+        c.busy += weight;
+        if (rs.ready_to_writeback[i]) c.cdb_wait += weight;
+        else if (rs.qj[i] != NO_TAG || rs.qk[i] != NO_TAG) c.wait_operand += weight;
+        else if (rs.cycles_remaining[i] >= 0) c.executing += weight;
+    }
+    for (int i = 0; i < ls.size(); ++i) {
+        if (!ls.busy[i]) continue;
+        StationCounters& c = stats.stations[rs.size() + i];
+        c.busy += weight;
+        if (ls.ready_to_writeback[i]) c.cdb_wait += weight;
+        else if (!ls.address_ready[i]) {
+            if (ls.base_producer[i] != NO_TAG) c.wait_operand += weight;
+        }
+        else if (ls.op[i] == OP_LOAD && load_blocked(i)) c.mem_hazard += weight;
+        else if (ls.op[i] == OP_STORE && ls.store_producer[i] != NO_TAG) c.wait_operand += weight;
+        else c.executing += weight;
+    }
+}
+
+bool Simulator::open_counters_output(const std::string& filename) {
+    counters_out.open(filename);
+    if (!counters_out) {
+        std::cerr << "Erro ao criar arquivo de contadores: " << filename << std::endl;
+        return false;
+    }
+    return true;
+}
+
+// --- Log de Eventos ---
+
+EventLogHeader Simulator::log_header() const {
+    EventLogHeader header = EventLogHeader();
+    header.add_rs = config.add_rs;
+    header.mul_rs = config.mul_rs;
+    header.ls_buffers = config.ls_buffers;
+    header.level = config.log_level;
+    return header;
+}
+
+void Simulator::start_log() {
+    log_events = (config.log_level == LOG_EVENTS);
+    log_summary = (config.log_level == LOG_SUMMARY);
+}
+
+bool Simulator::open_event_log(const std::string& filename) {
+    if (verbose) {
+        std::cerr << "--log-out exige --batch ou --quiet (no modo interativo os eventos vao para a tela)" << std::endl;
+        return false;
+    }
+    if (!event_log.open_file(filename, log_header())) return false;
+    start_log();
+    return true;
+}
+
+// Pilha de CPI, paradas por motivo e ocupacao das estacoes, em JSON
+void Simulator::write_counters_json(std::ostream& out) {
+    long committed = std::max(1L, stats.committed);
+    double cycles = std::max(1L, stats.cycles);
+    out << std::fixed << std::setprecision(4);
+    out << "{\n";
+    out << "  \"cycles\": " << stats.cycles << ",\n";
+    out << "  \"committed\": " << stats.committed << ",\n";
+    out << "  \"fast_forwarded\": " << stats.fast_forwarded << ",\n";
+    out << "  \"finished\": " << (stats.finished ? "true" : "false") << ",\n";
+    out << "  \"ipc\": " << stats.ipc() << ",\n";
+    out << "  \"cpi\": " << (double)stats.cycles / committed << ",\n";
+    out << "  \"interval\": {\"start_cycle\": " << stats.start_cycle << ", \"cycles\": " << stats.cycles - stats.start_cycle
+        << ", \"committed\": " << stats.committed - stats.start_committed << ", \"ipc\": " << stats.interval_ipc() << "},\n";
+
+    out << "  \"cpi_stack\": {\n";
+    for (int k = 0; k < CPI_COUNT; ++k) {
+        out << "    \"" << cpi_category_name((CpiCategory)k) << "\": {\"cycles\": " << stats.cpi[k]
+            << ", \"cpi\": " << (double)stats.cpi[k] / committed << "}" << (k + 1 < CPI_COUNT ? "," : "") << "\n";
+    }
+    out << "  },\n";
+
+    long operand_wait = 0, mem_hazard = 0;
+    for (const StationCounters& c : stats.stations) {
+        operand_wait += c.wait_operand;
+        mem_hazard += c.mem_hazard;
+    }
+    out << "  \"stalls\": {\n";
+    out << "    \"issue_no_rs_add\": " << stats.stall_rs_add << ",\n";
+    out << "    \"issue_no_rs_mul\": " << stats.stall_rs_mul << ",\n";
+    out << "    \"issue_no_ls\": " << stats.stall_ls << ",\n";
+    out << "    \"issue_rob_full\": " << stats.stall_rob << ",\n";
+    out << "    \"issue_window_full\": " << stats.stall_window << ",\n";
+    out << "    \"operand_not_ready\": " << operand_wait << ",\n";
+    out << "    \"memory_hazard\": " << mem_hazard << ",\n";
+    out << "    \"cdb_conflict\": " << stats.cdb_conflicts << ",\n";
+    out << "    \"commit_blocked\": " << stats.cycles - stats.cpi[CPI_BASE] << ",\n";
+    out << "    \"commit_width_limited\": " << stats.commit_width_limited << "\n";
+    out << "  },\n";
+
+    out << "  \"issue\": {\"width\": " << config.issue_width << ", \"issued\": " << stats.issued
+        << ", \"per_cycle\": " << stats.issued / cycles << ", \"full_width_cycles\": " << stats.issue_width_full << "},\n";
+    out << "  \"cdb\": {\"buses\": " << config.cdb_count << ", \"arbitration\": \""
+        << (config.cdb_arbitration == CDB_OLDEST_FIRST ? "oldest" : "station") << "\", \"broadcasts\": " << stats.cdb_broadcasts
+        << ", \"per_cycle\": " << stats.cdb_broadcasts / cycles << ", \"conflicts\": " << stats.cdb_conflicts << "},\n";
+    out << "  \"memory\": {\"store_forwarding\": " << (config.store_forwarding ? "true" : "false")
+        << ", \"loads_forwarded\": " << stats.loads_forwarded << "},\n";
+    out << "  \"caches\": [";
+    const Cache* levels[] = {&caches.l1, &caches.l2};
+    for (int k = 0, listed = 0; k < 2; ++k) {
+        const Cache& c = *levels[k];
+        if (!c.enabled()) continue;
+        const CacheStats& s = c.stats;
+        out << (listed++ > 0 ? "," : "") << "\n    {\"level\": \"L" << (k + 1) << "\", \"size\": " << c.params().size
+            << ", \"assoc\": " << c.params().assoc << ", \"line\": " << c.params().line
+            << ", \"accesses\": " << s.accesses << ", \"hits\": " << s.hits << ", \"misses\": " << s.misses
+            << ", \"hit_rate\": " << (s.accesses > 0 ? (double)s.hits / s.accesses : 0.0)
+            << ", \"mshr_merges\": " << s.mshr_merges << ", \"writebacks\": " << s.writebacks
+            << ", \"mshr_stalls\": " << s.mshr_stalls << "}";
+    }
+    out << (caches.enabled() ? "\n  ],\n" : "],\n");
+    out << "  \"rob\": {\"entries\": " << rob.capacity << ", \"occupancy_avg\": "
+        << stats.rob_occupancy_sum / cycles << ", \"occupancy_max\": " << stats.rob_occupancy_max << "},\n";
+
+    out << "  \"stations\": [\n";
+    for (size_t i = 0; i < stats.stations.size(); ++i) {
+        const StationCounters& c = stats.stations[i];
+        out << "    {\"name\": \"" << tag_name((Tag)i + 1) << "\", \"busy\": " << c.busy
+            << ", \"utilization\": " << c.busy / cycles
+            << ", \"executing\": " << c.executing << ", \"wait_operand\": " << c.wait_operand
+            << ", \"memory_hazard\": " << c.mem_hazard << ", \"cdb_wait\": " << c.cdb_wait << "}"
+            << (i + 1 < stats.stations.size() ? "," : "") << "\n";
+    }
+    out << "  ]\n";
+    out << "}\n";
+}
+
+
+// --- NOVO ESTÁGIO: Commit (Comprometimento) ---
+
+template <bool Observed>
+void Simulator::commit() {
+    // Commit em ordem de programa a partir da cabeca do ROB, ate commit_width por ciclo
+    int committed_now = 0;
+    while (!rob.empty()) {
+        if (config.commit_width > 0 && committed_now == config.commit_width) {
+            if (rob.at(rob.head).ready) stats.commit_width_limited++;
+            break;
+        }
+        ROB_Entry& entry = rob.at(rob.head);
+        if (!entry.ready) break;
+        Instruction &inst = inst_at(rob.head);
+
+        if (inst.op == OP_STORE) {
+            // --- STORE --- (o endereco sempre foi calculado antes do writeback,
+            // inclusive quando negativo)
+            memory.write(entry.address, entry.value);
+            if (recording_stores) store_records.push_back(StoreRecord{cycle, entry.address, entry.value});
+            if (log_events) {
+                LogEvent e = event(EV_COMMIT_STORE);
+                e.a = inst.id;
+                e.b = entry.address;
+                e.value = entry.value;
+                event_log.push(e);
+            }
+            store_queue.retire();
+
+        } else {
+            // --- LOAD / ALU instruction ---
+            if (inst.dest >= 0) {
+                if (reg_producer[inst.dest] == inst.id) {
+                    reg_file[inst.dest] = entry.value;
+                    reg_status[inst.dest] = NO_TAG;
+                    reg_producer[inst.dest] = -1;
+
+                    if (log_events) {
+                        LogEvent e = event(EV_COMMIT_WRITE);
+                        e.a = inst.id;
+                        e.reg[0] = inst.dest;
+                        e.value = entry.value;
+                        event_log.push(e);
+                    }
+                } else if (log_events) {
+                    LogEvent e = event(EV_COMMIT_SKIP_WRITE);
+                    e.reg[0] = inst.dest;
+                    event_log.push(e);
+                }
+
+                // ✅ NOVO: Acorda dependentes emitidos depois do WRITEBACK
+                // (eles capturaram a tag em reg_status e ainda esperam),
+                // mesmo que o registrador ja tenha sido renomeado de novo
+                wake_waiters(entry.producer_tag, inst.id, entry.value);
+            }
+        }
+
+        inst.state = COMMITTED;
+        inst.commit_cycle = cycle;
+        if (timing_out.is_open()) write_timing_row(inst);
+        if (Observed) observer->on_commit(*this, inst, entry.value);
+        rob.retire();
+        committed_inst_count++;
+        committed_now++;
+    }
+    if (committed_now > 0) stats.commit_active_cycles++;
+    stats.cpi[committed_now > 0 ? CPI_BASE : blame_rob_head()]++;
+}
+
+
+// --- Estagio de Emissao (Issue) - ATUALIZADO ---
+// Emite ate issue_width instrucoes, em ordem; para na primeira que nao pode ser emitida
+template <bool Observed>
+void Simulator::issue() {
+    issue_progress = false;
+    issue_stall = nullptr;
+    int issued = 0;
+    while (issued < config.issue_width && issue_one<Observed>()) ++issued;
+
+    issue_progress = (issued > 0);
+    stats.issued += issued;
+    if (issued == config.issue_width) stats.issue_width_full++;
+}
+
+// Emite a instrucao em 'pc', se houver estacao e entrada no ROB livres
+template <bool Observed>
+bool Simulator::issue_one() {
+    if (pc == fetched && !fetch_next()) {
+        if (source_done) {
+            if (log_events) event_log.push(event(EV_ISSUE_DONE));
+        } else {
+            issue_stall = &stats.stall_window;
+            stats.stall_window++;
+            if (log_events) event_log.push(event(EV_ISSUE_WINDOW_FULL));
+        }
+        return false;
+    }
+
+    if (rob.full()) {
+        issue_stall = &stats.stall_rob;
+        stats.stall_rob++;
+        if (log_events) {
+            LogEvent e = event(EV_ISSUE_ROB_FULL);
+            e.a = rob.occupancy();
+            event_log.push(e);
+        }
+        return false;
+    }
+
+    Instruction& inst = inst_at(pc);
+
+    // --- 1. Aritmetica/Logica (ADD, SUB, MUL, DIV) ---
+    if (inst.fu != FU_LS) {
+        // Faixa de slots da classe: Add = [0, add_rs), Mult = [add_rs, rs.size())
+        int first = (inst.fu == FU_ADD) ? 0 : config.add_rs;
+        int last = (inst.fu == FU_ADD) ? config.add_rs : rs.size();
+
+        int slot = -1;
+        for (int i = first; i < last; ++i) {
+            if (!rs.busy[i]) {
+                slot = i;
+                break;
+            }
+        }
+
+        if (slot < 0) {
+            issue_stall = (inst.fu == FU_ADD) ? &stats.stall_rs_add : &stats.stall_rs_mul;
+            ++*issue_stall;
+            if (log_events) {
+                LogEvent e = event(EV_ISSUE_NO_RS);
+                e.op = inst.op;
+                event_log.push(e);
+            }
+            return false;
+        }
+
+        Tag tag = rs_tag(slot);
+        if (log_events) {
+            LogEvent e = event(EV_ISSUE, tag);
+            e.a = pc + 1;
+            e.b = source_done ? fetched : -1;
+            e.op = inst.op;
+            e.reg[0] = inst.dest;
+            e.reg[1] = inst.src1;
+            e.reg[2] = inst.src2;
+            event_log.push(e);
+        }
+
+        // Preencher a RS
+        rs.busy[slot] = true;
+        rs.op[slot] = inst.op;
+        rs.instruction_id[slot] = inst.id; // NOVO: Rastreamento do ID
+        rs.cycles_remaining[slot] = -1; 
+        rs.ready_to_writeback[slot] = false;
+
+        // Preencher Vj/Qj e Vk/Qk (logica de renomeacao)
+        rename_source(inst.src1, tag, 0, rs.vj[slot], rs.qj[slot]);
+        rename_source(inst.src2, tag, 1, rs.vk[slot], rs.qk[slot]);
+
+        // Renomear o registrador de destino
+        rename_dest(inst.dest, tag, inst.id);
+        
+        // NOVO: Atualizar estado da instrucao
+        inst.state = ISSUED;
+        inst.issue_cycle = cycle;
+        rob.allocate();
+        pc++;
+        if (Observed) observer->on_issue(*this, inst, tag);
+        
+    // --- 2. Load/Store (LOAD, STORE) ---
+    } else {
+        int slot = -1;
+        for (int i = 0; i < ls.size(); ++i) {
+            if (!ls.busy[i]) {
+                slot = i;
+                break;
+            }
+        }
+
+        if (slot < 0) {
+            issue_stall = &stats.stall_ls;
+            stats.stall_ls++;
+            if (log_events) {
+                LogEvent e = event(EV_ISSUE_NO_LS);
+                e.op = inst.op;
+                event_log.push(e);
+            }
+            return false;
+        }
+
+        Tag tag = ls_tag(slot);
+        if (log_events) {
+            LogEvent e = event(EV_ISSUE_LS, tag);
+            e.a = pc + 1;
+            e.b = source_done ? fetched : -1;
+            e.op = inst.op;
+            e.d = inst.offset;
+            e.reg[0] = inst.dest;
+            e.reg[1] = inst.src1;
+            event_log.push(e);
+        }
+
+        ls.busy[slot] = true;
+        ls.op[slot] = inst.op;
+        ls.dest_reg[slot] = inst.dest; 
+        ls.offset[slot] = inst.offset; 
+        ls.instruction_id[slot] = inst.id; // NOVO: Rastreamento do ID
+        ls.cycles_remaining[slot] = -1; 
+        ls.address_ready[slot] = false;
+        ls.ready_to_writeback[slot] = false;
+        ls.store_value[slot] = 0.0;
+        ls.store_producer[slot] = NO_TAG;
+        ls.store_number[slot] = (inst.op == OP_STORE) ? store_queue.push(inst.id, slot) : -1;
+
+        // A. Base Register (SRC1)
+        rename_source(inst.src1, tag, 0, ls.base_value[slot], ls.base_producer[slot]);
+
+        // B. Store Value (Dest Reg) - Apenas para STORE
+        if (inst.op == OP_STORE) {
+            rename_source(inst.dest, tag, 1, ls.store_value[slot], ls.store_producer[slot]);
+        }
+
+        // C. Renomeacao: Apenas LOAD renomeia o registrador de destino
+        if (inst.op == OP_LOAD) {
+            rename_dest(inst.dest, tag, inst.id);
+        }
+
+        // NOVO: Atualizar estado da instrucao
+        inst.state = ISSUED;
+        inst.issue_cycle = cycle;
+        rob.allocate();
+        pc++;
+        if (Observed) observer->on_issue(*this, inst, tag);
+    }
+    return true;
+}
+
+// --- Estagio de Execucao (Execute) - ATUALIZADO ---
+template <bool Observed>
+void Simulator::execute() {
+    bool exec_activity = false;
+    
+    // --- 1. Processa RS de Aritmetica/Logica ---
+    for (int i = 0; i < rs.size(); ++i) {
+        if (!rs.busy[i] || rs.ready_to_writeback[i]) continue;
+
+        if (rs.qj[i] == NO_TAG && rs.qk[i] == NO_TAG) {
+            OpCode op = rs.op[i];
+            Instruction& inst = inst_at(rs.instruction_id[i]);
+            
+            // NOVO: 1. Iniciar execucao (se cycles_remaining == -1)
+            if (rs.cycles_remaining[i] == -1) {
+                int latency = inst.latency;
+                rs.cycles_remaining[i] = latency;
+                inst.state = EXECUTING; // Atualiza estado
+                inst.exec_start_cycle = cycle; // Atualiza tempo
+                if (log_events) {
+                    LogEvent e = event(EV_EXEC_START, rs_tag(i));
+                    e.op = op;
+                    e.d = latency;
+                    event_log.push(e);
+                }
+                if (Observed) observer->on_execute_start(*this, inst, rs_tag(i));
+                exec_activity = true;
+            }
+            
+            // 2. Decrementar contador
+            if (rs.cycles_remaining[i] > 0) {
+                rs.cycles_remaining[i]--;
+                exec_activity = true;
+            }
+
+            // NOVO: 3. Execucao concluida (cycles_remaining == 0)
+            if (rs.cycles_remaining[i] == 0) {
+                // Calculo do resultado
+                double vj = rs.vj[i], vk = rs.vk[i];
+                if (op == OP_ADD) rs.result[i] = vj + vk;
+                else if (op == OP_SUB) rs.result[i] = vj - vk;
+                else if (op == OP_MUL) rs.result[i] = vj * vk;
+                else if (op == OP_DIV) rs.result[i] = (vk == 0) ? 0.0 : vj / vk;
+                
+                if (log_events) {
+                    LogEvent e = event(EV_EXEC_DONE, rs_tag(i));
+                    e.value = rs.result[i];
+                    event_log.push(e);
+                }
+                rs.ready_to_writeback[i] = true;
+                inst.exec_end_cycle = cycle; // Atualiza tempo
+                if (Observed) observer->on_execute_end(*this, inst, rs_tag(i), rs.result[i]);
+                exec_activity = true;
+            }
+        }
+    }
+
+
+    // --- 2. Processa Buffers de Load/Store (L/S) - ATUALIZADO ---
+    for (int i = 0; i < ls.size(); ++i) {
+        if (!ls.busy[i] || ls.ready_to_writeback[i]) continue;
+
+        Instruction& inst = inst_at(ls.instruction_id[i]);
+        OpCode op = ls.op[i];
+
+        // A. Calculo de Endereco (Execucao do Endereco)
+        if (!ls.address_ready[i] && ls.base_producer[i] == NO_TAG) {
+            ls.calculated_address[i] = (long)(ls.base_value[i] + ls.offset[i]);
+            ls.address_ready[i] = true;
+            // Latencia fixa comeca a contar ja; com caches ela so e conhecida no acesso
+            ls.cycles_remaining[i] = caches.enabled() ? -1 : inst.latency;
+            
+            // NOVO: Marca o inicio da execucao
+            inst.state = EXECUTING;
+            inst.exec_start_cycle = cycle; 
+            rob.at(inst.id).address = ls.calculated_address[i]; // Salva endereco no ROB
+            if (op == OP_STORE) store_queue.resolve(ls.store_number[i], ls.calculated_address[i]);
+            
+            if (log_events) {
+                LogEvent e = event(EV_EXEC_ADDRESS, ls_tag(i));
+                e.op = op;
+                e.a = ls.calculated_address[i];
+                event_log.push(e);
+            }
+            if (Observed) observer->on_execute_start(*this, inst, ls_tag(i));
+            exec_activity = true;
+        } 
+        
+        // B. Acesso a Memoria (Execucao de Memoria)
+        if (ls.address_ready[i]) {
+            
+            // Ordem de memoria: o LOAD espera STOREs mais antigos sem endereco ou,
+            // no mesmo endereco, sem valor para encaminhar. STOREs so escrevem
+            // no commit, em ordem, entao nunca esperam outros acessos.
+            if (op == OP_LOAD && load_blocked(i)) {
+                if (log_events) event_log.push(event(EV_EXEC_MEM_HAZARD, ls_tag(i)));
+                continue; 
+            }
+
+            // Para STORE: Deve esperar o valor a ser armazenado (RAW no valor)
+            if (op == OP_STORE && ls.store_producer[i] != NO_TAG) {
+                 if (log_events) {
+                     LogEvent e = event(EV_EXEC_STORE_WAIT, ls_tag(i));
+                     e.d = ls.store_producer[i];
+                     event_log.push(e);
+                 }
+                 continue; 
+            }
+
+            // Acesso aos caches no primeiro ciclo livre: acerto, falha ou espera por MSHR
+            if (ls.cycles_remaining[i] < 0) {
+                int latency = caches.access(ls.calculated_address[i], op == OP_STORE, cycle);
+                if (latency < 0) {
+                    if (log_events) {
+                        LogEvent e = event(EV_EXEC_NO_MSHR, ls_tag(i));
+                        e.op = op;
+                        event_log.push(e);
+                    }
+                    continue;
+                }
+                ls.cycles_remaining[i] = latency;
+                if (log_events) {
+                    LogEvent e = event(EV_EXEC_CACHE, ls_tag(i));
+                    e.op = op;
+                    e.d = latency;
+                    event_log.push(e);
+                }
+            }
+
+            // Decrementar contador de acesso a memoria
+            if (ls.cycles_remaining[i] > 0) {
+                ls.cycles_remaining[i]--;
+                exec_activity = true;
+            }
+
+            // Acesso a Memoria Concluido
+            if (ls.cycles_remaining[i] == 0) {
+                // NOVO: Marca o fim da execucao
+                inst.exec_end_cycle = cycle; 
+
+                if (op == OP_LOAD) {
+                    long store = forwarding_store(i);
+                    if (store >= 0) {
+                        ls.result[i] = store_data(store);
+                        stats.loads_forwarded++;
+                        if (log_events) {
+                            LogEvent e = event(EV_EXEC_FORWARD, ls_tag(i));
+                            e.a = store_queue.seq(store);
+                            e.value = ls.result[i];
+                            event_log.push(e);
+                        }
+                    } else {
+                        ls.result[i] = memory.read(ls.calculated_address[i]);
+                        if (log_events) {
+                            LogEvent e = event(EV_EXEC_LOAD, ls_tag(i));
+                            e.value = ls.result[i];
+                            event_log.push(e);
+                        }
+                    }
+                } else if (op == OP_STORE) {
+                    if (log_events) event_log.push(event(EV_EXEC_STORE, ls_tag(i)));
+                }
+                ls.ready_to_writeback[i] = true;
+                if (Observed) {
+                    observer->on_execute_end(*this, inst, ls_tag(i), op == OP_STORE ? ls.store_value[i] : ls.result[i]);
+                }
+                exec_activity = true;
+            }
+        }
+    }
+
+
+    if (!exec_activity && log_events) event_log.push(event(EV_EXEC_IDLE));
+}
+
+// --- Estagio de Escrita (Writeback) - ATUALIZADO E CORRIGIDO ---
+
+template <bool Observed>
+void Simulator::writeback() {
+    // Candidatos: estacoes com resultado pronto, indexadas como tag - 1
+    // (RS seguidas dos L/S), na ordem das estacoes ou da mais antiga
+    cdb_candidates.clear();
+    for (int i = 0; i < rs.size(); ++i) {
+        if (rs.busy[i] && rs.ready_to_writeback[i] && rs.instruction_id[i] >= 0 && rs.instruction_id[i] < fetched) {
+            cdb_candidates.push_back(i);
+        }
+    }
+    for (int i = 0; i < ls.size(); ++i) {
+        if (ls.busy[i] && ls.ready_to_writeback[i] && ls.instruction_id[i] >= 0 && ls.instruction_id[i] < fetched) {
+            cdb_candidates.push_back(rs.size() + i);
+        }
+    }
+    if (config.cdb_arbitration == CDB_OLDEST_FIRST) {
+        auto seq_of = [this](int s) { return s < rs.size() ? rs.instruction_id[s] : ls.instruction_id[s - rs.size()]; };
+        std::sort(cdb_candidates.begin(), cdb_candidates.end(),
+                  [&seq_of](int a, int b) { return seq_of(a) < seq_of(b); });
+    }
+
+    // Concessao: com cdb_count = 0 ha um barramento para as RS e outro para
+    // os L/S; senao os cdb_count barramentos sao compartilhados
+    int granted = 0;
+    bool rs_bus = false, ls_bus = false;
+    for (int s : cdb_candidates) {
+        bool is_rs = s < rs.size();
+        if (config.cdb_count == 0) {
+            bool& bus = is_rs ? rs_bus : ls_bus;
+            if (bus) continue;
+            bus = true;
+        } else if (granted == config.cdb_count) {
+            break;
+        }
+        if (is_rs) broadcast_rs<Observed>(s);
+        else broadcast_ls<Observed>(s - rs.size());
+        ++granted;
+    }
+
+    // As demais estacoes prontas perdem o ciclo (conflito de CDB)
+    stats.cdb_broadcasts += granted;
+    stats.cdb_conflicts += (long)cdb_candidates.size() - granted;
+}
+
+// Transmite o resultado da RS 'i' no CDB: guarda no ROB, acorda os
+// dependentes e libera a estacao
+template <bool Observed>
+void Simulator::broadcast_rs(int i) {
+    long inst_id = rs.instruction_id[i];
+    Instruction &inst = inst_at(inst_id);
+
+    double result = rs.result[i];
+    Tag tag = rs_tag(i);
+
+    // Guarda resultado no ROB (aguarda commit)
+    ROB_Entry& entry = rob.at(inst_id);
+    entry.value = result;
+    entry.ready = true;
+    entry.producer_tag = tag;
+    inst.write_cycle = cycle;
+    inst.state = WRITE_RESULT;
+
+    if (log_events) {
+        LogEvent e = event(EV_WB_BROADCAST, tag);
+        e.value = result;
+        event_log.push(e);
+    }
+    if (Observed) observer->on_writeback(*this, inst, tag, result);
+
+    // Broadcast (atualiza apenas os operandos dependentes desta tag)
+    wake_waiters(tag, inst_id, result);
+
+    // Libera estação
+    rs.busy[i] = false;
+    rs.ready_to_writeback[i] = false;
+    rs.instruction_id[i] = -1;
+    rs.cycles_remaining[i] = -1;
+    rs.result[i] = 0.0;
+}
+
+// Conclui o LOAD/STORE do buffer 'i': resultado no ROB e buffer liberado
+template <bool Observed>
+void Simulator::broadcast_ls(int i) {
+    long inst_id = ls.instruction_id[i];
+    Instruction &inst = inst_at(inst_id);
+    Tag tag = ls_tag(i);
+    ROB_Entry& entry = rob.at(inst_id);
+
+    if (ls.op[i] == OP_LOAD) {
+        entry.value = ls.result[i];
+        entry.ready = true;
+        entry.producer_tag = tag;
+        inst.write_cycle = cycle;
+        inst.state = WRITE_RESULT;
+        if (log_events) {
+            LogEvent e = event(EV_WB_LOAD, tag);
+            e.value = ls.result[i];
+            event_log.push(e);
+        }
+    } else if (ls.op[i] == OP_STORE) {
+        // STORE não escreve nada no registrador, só sinaliza commit futuro
+        entry.value = ls.store_value[i];
+        entry.ready = true;
+        entry.producer_tag = tag;
+        inst.write_cycle = cycle;
+        inst.state = WRITE_RESULT;
+        if (log_events) event_log.push(event(EV_WB_STORE, tag));
+    }
+    if (Observed) observer->on_writeback(*this, inst, tag, entry.value);
+
+    // Libera a estação L/S
+    ls.busy[i] = false;
+    ls.op[i] = OP_NONE;
+    ls.dest_reg[i] = -1;
+    ls.base_producer[i] = NO_TAG;
+    ls.store_producer[i] = NO_TAG;
+    ls.address_ready[i] = false;
+    ls.ready_to_writeback[i] = false;
+    ls.cycles_remaining[i] = -1;
+    ls.instruction_id[i] = -1;
+    ls.store_number[i] = -1;
+}
+
+
+
+
+// --- Renomeacao de Registradores ---
+// Le o operando 'reg' para a estacao 'consumer': copia o valor se estiver pronto,
+// senao guarda a tag do produtor e entra na lista de espera dele
+void Simulator::rename_source(int reg, Tag consumer, int operand, double& value, Tag& producer) {
+    if (reg_status[reg] == NO_TAG) {
+        value = reg_file[reg];
+        producer = NO_TAG;
+    } else {
+        producer = reg_status[reg];
+        add_waiter(producer, reg_producer[reg], consumer, operand);
+    }
+}
+
+// Renomeia o registrador de destino para a estacao 'tag' (instrucao 'seq')
+void Simulator::rename_dest(int reg, Tag tag, long seq) {
+    reg_status[reg] = tag;
+    reg_producer[reg] = seq;
+}
+
+// --- Listas de Espera do CDB ---
+// Registra que o operando (0 = Qj/base, 1 = Qk/valor do STORE) da estacao
+// 'consumer' espera o resultado da instrucao 'producer_seq', na estacao 'producer'
+void Simulator::add_waiter(Tag producer, long producer_seq, Tag consumer, int operand) {
+    waiters[producer].push_back(Waiter{consumer * 2 + operand, producer_seq});
+}
+
+// Entrega 'value' aos consumidores que esperam a instrucao 'producer_seq' na
+// estacao 'tag'; esperas por outro produtor da mesma estacao continuam na lista
+void Simulator::wake_waiters(Tag tag, long producer_seq, double value) {
+    std::vector<Waiter>& list = waiters[tag];
+    size_t kept = 0;
+    for (const Waiter& w : list) {
+        if (w.producer != producer_seq) {
+            list[kept++] = w;
+            continue;
+        }
+        Tag consumer = w.consumer >> 1;
+        int operand = w.consumer & 1;
+        if (consumer <= rs.size()) {
+            int slot = consumer - 1;
+            if (operand == 0 && rs.qj[slot] == tag) { rs.vj[slot] = value; rs.qj[slot] = NO_TAG; }
+            if (operand == 1 && rs.qk[slot] == tag) { rs.vk[slot] = value; rs.qk[slot] = NO_TAG; }
+        } else {
+            int slot = consumer - rs.size() - 1;
+            if (operand == 0 && ls.base_producer[slot] == tag) { ls.base_value[slot] = value; ls.base_producer[slot] = NO_TAG; }
+            if (operand == 1 && ls.store_producer[slot] == tag) { ls.store_value[slot] = value; ls.store_producer[slot] = NO_TAG; }
+        }
+    }
+    list.resize(kept);
+}
+
+// Dobra a capacidade do ROB ilimitado, reposicionando as entradas vivas
+void ReorderBuffer::grow() {
+    std::vector<ROB_Entry> bigger(entries.size() * 2);
+    for (long seq = head; seq < tail; ++seq) {
+        bigger[seq % bigger.size()] = entries[seq % entries.size()];
+    }
+    entries.swap(bigger);
+}
+
+// --- Ordem de Memoria (StoreQueue) ---
+
+// STORE mais antigo, no mesmo endereco, cujo valor o LOAD do buffer 'slot'
+// deve receber (-1 = nenhum em voo; o valor vem da memoria)
+long Simulator::forwarding_store(int slot) {
+    return store_queue.youngest_before(ls.calculated_address[slot], ls.instruction_id[slot]);
+}
+
+// Valor do STORE 'number': no ROB depois do writeback, senao no buffer L/S
+double Simulator::store_data(long number) {
+    const ROB_Entry& entry = rob.at(store_queue.seq(number));
+    return entry.ready ? entry.value : ls.store_value[store_queue.slot(number)];
+}
+
+// O LOAD do buffer 'slot' (com endereco calculado) precisa esperar? Espera se
+// algum STORE mais antigo ainda nao tem endereco ou se o STORE a encaminhar
+// ainda nao tem o valor (ou, sem encaminhamento, enquanto ele nao comprometer)
+bool Simulator::load_blocked(int slot) {
+    if (store_queue.unresolved_before(ls.instruction_id[slot])) return true;
+    long store = forwarding_store(slot);
+    if (store < 0) return false;
+    if (!config.store_forwarding) return true;
+    return !rob.at(store_queue.seq(store)).ready && ls.store_producer[store_queue.slot(store)] != NO_TAG;
+}
+
+// Reconstroi a StoreQueue a partir do ROB e dos buffers L/S (restauracao de checkpoint)
+void Simulator::rebuild_store_queue() {
+    store_queue.clear();
+    for (long seq = committed_inst_count; seq < pc; ++seq) {
+        if (inst_at(seq).op != OP_STORE) continue;
+        int slot = -1;
+        for (int i = 0; i < ls.size(); ++i) {
+            if (ls.busy[i] && ls.instruction_id[i] == seq) slot = i;
+        }
+        long number = store_queue.push(seq, slot);
+        if (slot >= 0) {
+            ls.store_number[slot] = number;
+            if (ls.address_ready[slot]) store_queue.resolve(number, ls.calculated_address[slot]);
+        } else {
+            store_queue.resolve(number, rob.at(seq).address);   // ja fez writeback
+        }
+    }
+}
+
+// --- Funcoes de Checagem e Impressao (Atualizadas) ---
+
+bool Simulator::check_completion() {
+    return source_done && committed_inst_count == fetched;
+}
+
+// NOVO: Imprime o status detalhado das instrucoes
+void Simulator::print_instruction_status(std::ostream& out, long first, long last) {
+    out << "\n  --- STATUS DAS INSTRUCOES (ROB: " << rob.occupancy() << "/"
+              << (rob.capacity > 0 ? std::to_string(rob.capacity) : "ilimitado") << ") ---" << std::endl;
+    out << "    " << std::setw(3) << "ID" << " | " << std::setw(4) << "OP" << " | " << std::setw(12) << "Estado" << " | "
+              << std::setw(4) << "Issue" << " | " << std::setw(4) << "ExecS" << " | " << std::setw(4) << "ExecE" << " | " 
+              << std::setw(4) << "Write" << " | " << std::setw(4) << "Commit" << std::endl;
+    out << "    " << std::string(60, '-') << std::endl;
+
+    auto state_to_string = [](InstrState state) -> std::string {
+        switch (state) {
+            case NOT_ISSUED: return "NOT_ISSUED";
+            case ISSUED: return "ISSUED";
+            case EXECUTING: return "EXECUTING";
+            case WRITE_RESULT: return "WRITE_RESULT";
+            case COMMITTED: return "COMMITTED";
+            default: return "UNKNOWN";
+        }
+    };
+
+    for (long seq = first; seq < last; ++seq) {
+        const Instruction& inst = inst_at(seq);
+        std::string issue_c = inst.issue_cycle > 0 ? std::to_string(inst.issue_cycle) : "-";
+        std::string execs_c = inst.exec_start_cycle > 0 ? std::to_string(inst.exec_start_cycle) : "-";
+        std::string exece_c = inst.exec_end_cycle > 0 ? std::to_string(inst.exec_end_cycle) : "-";
+        std::string write_c = inst.write_cycle > 0 ? std::to_string(inst.write_cycle) : "-";
+        std::string commit_c = inst.commit_cycle > 0 ? std::to_string(inst.commit_cycle) : "-";
+
+        out << "    " << std::setw(3) << inst.id << " | " << std::setw(4) << op_name(inst.op) << " | " << std::setw(12) << state_to_string(inst.state) << " | "
+                  << std::setw(4) << issue_c << " | " << std::setw(4) << execs_c << " | " << std::setw(4) << exece_c << " | "
+                  << std::setw(4) << write_c << " | " << std::setw(4) << commit_c << std::endl;
+    }
+}
+
+
+void Simulator::print_state(std::ostream& out) {
+    out << std::fixed << std::setprecision(4); 
+
+    // --- Tabela de Estacoes de Reserva Aritmeticas ---
+    out << "\n  --- Estacoes de Reserva (Aritmeticas) ---" << std::endl;
+    out << "    " << std::setw(6) << "Nome" << " | " << std::setw(4) << "Busy" << " | " << std::setw(4) << "Op" << " | " << std::setw(10) << "Vj" << " | " << std::setw(10) << "Vk" << " | " << std::setw(6) << "Qj" << " | " << std::setw(6) << "Qk" << " | " << "Ciclos/ID" << std::endl;
+    out << "    " << std::string(75, '-') << std::endl;
+    
+    for (int i = 0; i < rs.size(); ++i) {
+        bool busy = rs.busy[i];
+        
+        std::string vj_str = "";
+        std::string vk_str = "";
+        if (busy) {
+            if (rs.qj[i] == NO_TAG) vj_str = std::to_string(rs.vj[i]); else vj_str = " ";
+            if (rs.qk[i] == NO_TAG) vk_str = std::to_string(rs.vk[i]); else vk_str = " ";
+        }
+
+        std::string id_str = std::to_string(rs.instruction_id[i]);
+        std::string cycles_str = "-";
+        if (!busy) cycles_str = "-";
+        else if (rs.ready_to_writeback[i]) cycles_str = "WB/ID" + id_str;
+        else if (rs.cycles_remaining[i] >= 0) cycles_str = std::to_string(rs.cycles_remaining[i]) + "/ID" + id_str;
+        else if (rs.cycles_remaining[i] == -1 && (rs.qj[i] == NO_TAG && rs.qk[i] == NO_TAG)) cycles_str = "RTS/ID" + id_str; 
+
+        std::string busy_str = busy ? "Sim" : "Nao";
+
+        out << "    " << std::setw(6) << tag_name(rs_tag(i)) << " | " << std::setw(4) << busy_str << " | " << std::setw(4) << op_name(rs.op[i]) << " | "
+                  << std::setw(10) << vj_str << " | "
+                  << std::setw(10) << vk_str << " | "
+                  << std::setw(6) << tag_name(rs.qj[i]) << " | " << std::setw(6) << tag_name(rs.qk[i]) << " | "
+                  << std::setw(10) << cycles_str << std::endl;
+    }
+    
+    // --- Tabela de Buffers de Load/Store (Memoria) ---
+    out << "\n  --- Buffers de Load/Store (Memoria) ---" << std::endl;
+    out << "    " << std::setw(6) << "Nome" << " | " << std::setw(4) << "Op" << " | " << std::setw(6) << "FDest" << " | " << std::setw(6) << "End_Calc" << " | " << std::setw(6) << "QBase" << " | " << std::setw(6) << "QStore" << " | " << "Ciclos/ID" << std::endl;
+    out << "    " << std::string(75, '-') << std::endl;
+    
+    for (int i = 0; i < ls.size(); ++i) {
+        std::string name = tag_name(ls_tag(i));
+        
+        if (!ls.busy[i]) {
+            out << "    " << std::setw(6) << name << " | " << std::setw(4) << "Nao" << " | " << std::setw(6) << "" << " | " << std::setw(6) << "-" << " | " << std::setw(6) << "" << " | " << std::setw(6) << "" << " | " << std::setw(10) << "-" << std::endl;
+            continue;
+        }
+
+        OpCode op = ls.op[i];
+        std::string id_str = std::to_string(ls.instruction_id[i]);
+        std::string addr_str = (ls.calculated_address[i] != -1) ? std::to_string(ls.calculated_address[i]) : "Calc";
+        
+        std::string cycles_str = "Wait/ID" + id_str;
+        if (ls.ready_to_writeback[i]) cycles_str = (op == OP_LOAD) ? "WB/ID" + id_str : "Done/ID" + id_str;
+        else if (ls.cycles_remaining[i] >= 0) cycles_str = std::to_string(ls.cycles_remaining[i]) + "/ID" + id_str;
+        else if (ls.address_ready[i]) cycles_str = "MemWait/ID" + id_str;
+        else if (ls.base_producer[i] == NO_TAG && op == OP_STORE && ls.store_producer[i] == NO_TAG) cycles_str = "RTS/ID" + id_str;
+        else if (ls.base_producer[i] == NO_TAG && op == OP_LOAD) cycles_str = "RTS/ID" + id_str;
+
+
+        out << "    " << std::setw(6) << name << " | " << std::setw(4) << op_name(op) << " | " << std::setw(6) << get_register_name(ls.dest_reg[i]) << " | " 
+                  << std::setw(6) << addr_str << " | " << std::setw(6) << tag_name(ls.base_producer[i]) << " | " 
+                  << std::setw(6) << (op == OP_STORE ? tag_name(ls.store_producer[i]) : "") << " | " << std::setw(10) << cycles_str << std::endl;
+    }
+
+
+    // --- Tabela de Status dos Registradores (Qi) ---
+    out << "\n  --- Status dos Registradores (Qi) ---" << std::endl;
+    // F0..F8 sempre; os demais registradores dos bancos so enquanto esperam um produtor
+    std::vector<int> shown;
+    for (int i = 0; i < NUM_REGS; ++i) {
+        if (i <= 8 || (reg_status[i] != NO_TAG && config.register_in_banks(i))) shown.push_back(i);
+    }
+    out << "   ";
+    for (int i : shown) {
+        std::string reg_name = get_register_name(i);
+        out << " | " << std::setw(8) << reg_name;
+    }
+    out << " |" << std::endl;
+    out << "   ";
+    for (int i : shown) {
+        Tag status = reg_status[i];
+        out << " | " << std::setw(8) << (status == NO_TAG ? "Pronto" : tag_name(status));
+    }
+    out << " |" << std::endl;
+
+    // --- Fila de Instrucoes (PC) ---
+    if (pc < fetched) {
+        const Instruction& next_inst = inst_at(pc);
+        out << "\n  --- Fila de Instrucoes (PC=" << pc+1 << "/" << (source_done ? std::to_string(fetched) : "?") << ") ---" << std::endl;
+        out << "    Proxima a emitir (ID " << next_inst.id << "): " << op_name(next_inst.op) << " " << get_register_name(next_inst.dest)
+                  << (next_inst.fu == FU_LS ? ", " + std::to_string(next_inst.offset) + "(" + get_register_name(next_inst.src1) + ")"
+                                            : ", " + get_register_name(next_inst.src1) + "," + get_register_name(next_inst.src2)) << std::endl;
+    } else if (!source_done) {
+        out << "\n  --- Fila de Instrucoes ---" << std::endl;
+        out << "    Proxima instrucao ainda nao buscada do trace." << std::endl;
+    } else {
+        out << "\n  --- Fila de Instrucoes ---" << std::endl;
+        out << "    Todas as instrucoes foram emitidas." << std::endl;
+    }
+}
+
+// Resumo final: total de ciclos, IPC, registradores e memoria
+void Simulator::print_summary() {
+    std::cout << "\n--- Simulacao Concluida em " << cycle << " Ciclos ---" << std::endl;
+    double ipc = stats.ipc();
+    long total = source_done ? fetched : (source ? source->count() : -1);
+    std::cout << "Instrucoes comprometidas: " << committed_inst_count << "/" << (total >= 0 ? total : fetched)
+              << (total >= 0 ? "" : " buscadas (trace nao lido ate o fim)")
+              << " | IPC: " << std::fixed << std::setprecision(4) << ipc << std::endl;
+    if (stats.fast_forwarded > 0) {
+        std::cout << "Fast-forward funcional: " << stats.fast_forwarded << " instrucoes antes do primeiro ciclo" << std::endl;
+    }
+    if (stats.start_cycle > 0) {
+        std::cout << (stats.warmed_up ? "Apos o aquecimento" : "Desde o checkpoint") << " (ciclo " << stats.start_cycle << "): "
+                  << cycle - stats.start_cycle << " ciclos, " << stats.committed - stats.start_committed << " instrucoes"
+                  << " | IPC: " << stats.interval_ipc() << std::endl;
+    }
+    print_rob_stats();
+    print_final_registers();
+    print_memory_state();
+}
+
+// Estatisticas do ROB (ocupacao e paradas por ROB cheio) e vazao do commit
+void Simulator::print_rob_stats() {
+    double avg_occupancy = (cycle > 0) ? (double)stats.rob_occupancy_sum / cycle : 0.0;
+    double per_active = (stats.commit_active_cycles > 0) ? (double)stats.committed / stats.commit_active_cycles : 0.0;
+    std::cout << std::fixed << std::setprecision(2);
+    std::cout << "ROB: " << (rob.capacity > 0 ? std::to_string(rob.capacity) + " entradas" : "ilimitado")
+              << " | ocupacao media " << avg_occupancy << ", maxima " << stats.rob_occupancy_max
+              << " | ciclos parados por ROB cheio: " << stats.stall_rob << std::endl;
+    std::cout << "Commit: largura " << (config.commit_width > 0 ? std::to_string(config.commit_width) : "ilimitada")
+              << " | " << per_active << " instrucoes por ciclo com commit"
+              << " | ciclos limitados pela largura: " << stats.commit_width_limited << std::endl;
+    std::cout << "Issue: largura " << config.issue_width
+              << " | " << (cycle > 0 ? (double)stats.issued / cycle : 0.0) << " instrucoes por ciclo"
+              << " | ciclos na largura maxima: " << stats.issue_width_full << std::endl;
+    std::cout << "CDB: " << (config.cdb_count > 0 ? std::to_string(config.cdb_count) + " compartilhado(s)" : "1 RS + 1 L/S")
+              << ", arbitragem " << (config.cdb_arbitration == CDB_OLDEST_FIRST ? "oldest" : "station")
+              << " | " << (cycle > 0 ? (double)stats.cdb_broadcasts / cycle : 0.0) << " transmissoes por ciclo"
+              << " | conflitos: " << stats.cdb_conflicts << std::endl;
+    std::cout << "Memoria: encaminhamento STORE->LOAD " << (config.store_forwarding ? "ligado" : "desligado")
+              << " | LOADs encaminhados: " << stats.loads_forwarded << std::endl;
+    const Cache* levels[] = {&caches.l1, &caches.l2};
+    for (int k = 0; k < 2; ++k) {
+        const Cache& c = *levels[k];
+        if (!c.enabled()) continue;
+        const CacheParams& p = c.params();
+        const CacheStats& s = c.stats;
+        std::cout << "L" << (k + 1) << ": " << p.size << " B, " << p.assoc << " vias, linhas de " << p.line << " B"
+                  << " | acessos: " << s.accesses << " | acertos: " << s.hits
+                  << " (" << (s.accesses > 0 ? 100.0 * s.hits / s.accesses : 0.0) << "%)"
+                  << " | falhas: " << s.misses << " | em transito: " << s.mshr_merges
+                  << " | write-backs: " << s.writebacks << " | esperas por MSHR: " << s.mshr_stalls << std::endl;
+    }
+}
+
+void Simulator::print_final_registers() {
+    std::cout << "\nValores Finais dos Registradores:" << std::endl;
+    std::cout << std::fixed << std::setprecision(4);
+    // F0..F8 sempre; os demais registradores dos bancos so com valor diferente de zero
+    for (int i = 0; i < NUM_REGS; ++i) {
+        if (i > 8 && (reg_file[i] == 0.0 || !config.register_in_banks(i))) continue;
+        std::cout << "  " << get_register_name(i) << ": " << reg_file[i] << std::endl;
+    }
+}
+
+void Simulator::print_memory_state() {
+    std::cout << "\nConteudo Final da Memoria (Enderecos Modificados):" << std::endl;
+    std::cout << std::fixed << std::setprecision(4);
+    for (auto const& pair : memory.written_cells()) {
+        std::cout << "  [" << pair.first << "]: " << pair.second << std::endl;
+    }
 }
\ No newline at end of file
@@ -1,151 +1,496 @@
-#ifndef SIMULATOR_H
-#define SIMULATOR_H
-
-#include <iostream>
-#include <fstream>
-#include <sstream>
-#include <string>
-#include <vector>
-#include <map>
-#include <cmath>
-#include <algorithm>
-#include <cstdlib>
-
-// --- Constantes de Configuracao ---
-#define ADD_RS_COUNT 3
-#define MUL_RS_COUNT 2
-#define LS_COUNT 2
-
-// Latencias das Unidades Funcionais (em ciclos)
-#define ADD_LATENCY 2
-#define MUL_LATENCY 10
-#define DIV_LATENCY 40
-#define MEM_ACCESS_LATENCY 3
-
-// --- NOVOS ENUMS E ESTRUTURAS DE DADOS ---
-using OpType = std::string;
-
-enum InstrState {
-    NOT_ISSUED,
-    ISSUED,
-    EXECUTING,
-    WRITE_RESULT,
-    COMMITTED
-};
-
-// Representa uma instrucao COMPLETA (incluindo estados e tempos)
-struct Instruction {
-    int id;
-    OpType op;
-    std::string dest;
-    std::string src1;
-    std::string src2;
-    long address;
-
-    InstrState state;
-    int issue_cycle;
-    int exec_start_cycle;
-    int exec_end_cycle;
-    int write_cycle;
-    int commit_cycle;
-
-    // --- Added for ROB-like commit handling ---
-    double value;              // resultado produzido (guardado no WRITEBACK)
-    bool has_value;            // true se o resultado ja foi gerado
-    std::string producer_tag;  // tag da RS que produz este resultado
-    bool is_store;             // true se instrucao for STORE
-
-    Instruction()
-        : id(-1),
-          op(""),
-          dest(""),
-          src1(""),
-          src2(""),
-          address(-1),
-          state(NOT_ISSUED),
-          issue_cycle(0),
-          exec_start_cycle(0),
-          exec_end_cycle(0),
-          write_cycle(0),
-          commit_cycle(0),
-          value(0.0),
-          has_value(false),
-          producer_tag(""),
-          is_store(false) {}
-};
-
-// Representa uma entrada na Estacao de Reserva (RS)
-struct RS_Entry {
-    std::string name;
-    bool busy = false;
-    std::string op = "";
-    double vj = 0.0;
-    double vk = 0.0;
-    std::string qj = "";
-    std::string qk = "";
-    int instruction_id = -1;
-    int cycles_remaining = -1;
-    double result = 0.0;
-    bool ready_to_writeback = false;
-};
-
-// Estrutura para o Buffer de Load/Store (LS)
-struct LS_Entry {
-    std::string name;
-    bool busy = false;
-    std::string op = "";
-    std::string dest_reg = "";
-    std::string base_reg = "";
-
-    double base_value = 0.0;
-    std::string base_producer = "";
-    int offset = 0;
-    long calculated_address = -1;
-    bool address_ready = false;
-
-    double store_value = 0.0;
-    std::string store_producer = "";
-
-    int instruction_id = -1;
-    int cycles_remaining = -1;
-    double result = 0.0;
-    bool ready_to_writeback = false;
-};
-
-class Simulator {
-private:
-    int cycle;
-    int pc;
-    bool simulation_complete;
-    int committed_inst_count;
-
-    std::vector<Instruction> instruction_queue;
-    std::map<std::string, RS_Entry> add_rs;
-    std::map<std::string, RS_Entry> mul_rs;
-    std::map<std::string, LS_Entry> ls_rs;
-
-    std::map<std::string, double> reg_file;
-    std::map<std::string, std::string> reg_status;
-    std::map<long, double> memory;
-
-    void commit();
-    void issue();
-    void execute();
-    void writeback();
-    bool check_completion();
-
-    void print_state();
-    void print_final_registers();
-    std::string get_register_name(int index);
-    void print_memory_state();
-    void print_instruction_status();
-
-    LS_Entry* find_address_hazard(long address, const std::string& current_name);
-
-public:
-    Simulator();
-    bool load_instructions(const std::string& filename);
-    void run();
-};
-
-#endif // SIMULATOR_H
+#ifndef SIMULATOR_H
+#define SIMULATOR_H
+
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <map>
+#include <cmath>
+#include <algorithm>
+#include <cstdlib>
+#include <cstdint>
+#include <memory>
+
+#include "trace.h"
+#include "memory.h"
+#include "lsq.h"
+#include "cache.h"
+#include "config.h"
+#include "eventlog.h"
+
+// --- NOVOS ENUMS E ESTRUTURAS DE DADOS ---
+
+// Modo de execucao do loop principal
+enum RunMode {
+    MODE_INTERACTIVE, // limpa a tela e espera ENTER a cada ciclo
+    MODE_BATCH,       // roda sem pausas e imprime apenas o resumo final
+    MODE_SILENT       // roda sem pausas e sem nenhuma saida
+};
+
+// Tag de produtor (renomeacao): 0 = valor pronto, senao indice global da estacao + 1.
+// As RS aritmeticas ocupam as primeiras tags, seguidas dos buffers L/S.
+// O nome textual ("Add1", "Mult2", "L/S1") so e gerado na impressao.
+using Tag = int;
+const Tag NO_TAG = 0;
+
+enum InstrState : uint8_t {
+    NOT_ISSUED,
+    ISSUED,
+    EXECUTING,
+    WRITE_RESULT,
+    COMMITTED
+};
+
+// Representa uma instrucao COMPLETA: registro decodificado + estados e tempos.
+// O id e o numero de sequencia global (posicao no trace), em 64 bits.
+struct Instruction : DecodedInst {
+    long id;
+
+    InstrState state;
+    long issue_cycle;
+    long exec_start_cycle;
+    long exec_end_cycle;
+    long write_cycle;
+    long commit_cycle;
+
+    Instruction()
+        : DecodedInst{OP_NONE, FU_ADD, 0, -1, -1, -1, 0},
+          id(-1),
+          state(NOT_ISSUED),
+          issue_cycle(0),
+          exec_start_cycle(0),
+          exec_end_cycle(0),
+          write_cycle(0),
+          commit_cycle(0) {}
+};
+
+// Entrada do Reorder Buffer: resultado especulativo aguardando o commit
+struct ROB_Entry {
+    double value;       // resultado produzido (guardado no WRITEBACK)
+    long address;       // endereco efetivo (LOAD/STORE), -1 se ainda nao calculado
+    Tag producer_tag;   // estacao que produziu o resultado
+    bool ready;         // true se o resultado ja foi gerado
+};
+
+// Reorder Buffer circular, alocado no issue e liberado no commit, sempre em
+// ordem de programa: a entrada da instrucao de sequencia s fica em
+// entries[s % entries.size()]. Com capacidade 0 (ilimitado) o buffer dobra
+// de tamanho quando enche, e o issue nunca para por falta de entrada.
+struct ReorderBuffer {
+    std::vector<ROB_Entry> entries;
+    int capacity;   // numero maximo de entradas (0 = ilimitado)
+    long head;      // sequencia da entrada mais antiga (proxima a comprometer)
+    long tail;      // sequencia da proxima entrada a alocar
+
+    ReorderBuffer() : capacity(0), head(0), tail(0) {}
+
+    void configure(int n) {
+        capacity = n;
+        entries.assign(n > 0 ? n : 64, ROB_Entry());
+        head = tail = 0;
+    }
+    long occupancy() const { return tail - head; }
+    bool full() const { return capacity > 0 && occupancy() >= capacity; }
+    bool empty() const { return head == tail; }
+    ROB_Entry& at(long seq) { return entries[seq % entries.size()]; }
+
+    // Aloca a entrada da instrucao de sequencia 'tail'
+    ROB_Entry& allocate() {
+        if (occupancy() == (long)entries.size()) grow();
+        ROB_Entry& entry = at(tail++);
+        entry.value = 0.0;
+        entry.address = -1;
+        entry.producer_tag = NO_TAG;
+        entry.ready = false;
+        return entry;
+    }
+    void retire() { ++head; }
+    void grow();
+};
+
+// Estacoes de Reserva aritmeticas (ADD/SUB seguidas de MUL/DIV) em layout SoA:
+// um vetor contiguo por campo, indexado pelo slot da estacao.
+struct RS_Table {
+    std::vector<char> busy;
+    std::vector<OpCode> op;
+    std::vector<double> vj;
+    std::vector<double> vk;
+    std::vector<Tag> qj;
+    std::vector<Tag> qk;
+    std::vector<long> instruction_id;
+    std::vector<int> cycles_remaining;
+    std::vector<double> result;
+    std::vector<char> ready_to_writeback;
+
+    void resize(int n) {
+        busy.assign(n, false);
+        op.assign(n, OP_NONE);
+        vj.assign(n, 0.0);
+        vk.assign(n, 0.0);
+        qj.assign(n, NO_TAG);
+        qk.assign(n, NO_TAG);
+        instruction_id.assign(n, -1);
+        cycles_remaining.assign(n, -1);
+        result.assign(n, 0.0);
+        ready_to_writeback.assign(n, false);
+    }
+    int size() const { return (int)busy.size(); }
+};
+
+// Buffers de Load/Store (LS) no mesmo layout SoA
+struct LS_Table {
+    std::vector<char> busy;
+    std::vector<OpCode> op;
+    std::vector<int> dest_reg;
+
+    std::vector<double> base_value;
+    std::vector<Tag> base_producer;
+    std::vector<int> offset;
+    std::vector<long> calculated_address;
+    std::vector<char> address_ready;
+
+    std::vector<double> store_value;
+    std::vector<Tag> store_producer;
+    std::vector<long> store_number;     // numero do STORE na StoreQueue
+
+    std::vector<long> instruction_id;
+    std::vector<int> cycles_remaining;
+    std::vector<double> result;
+    std::vector<char> ready_to_writeback;
+
+    void resize(int n) {
+        busy.assign(n, false);
+        op.assign(n, OP_NONE);
+        dest_reg.assign(n, -1);
+        base_value.assign(n, 0.0);
+        base_producer.assign(n, NO_TAG);
+        offset.assign(n, 0);
+        calculated_address.assign(n, -1);
+        address_ready.assign(n, false);
+        store_value.assign(n, 0.0);
+        store_producer.assign(n, NO_TAG);
+        store_number.assign(n, -1);
+        instruction_id.assign(n, -1);
+        cycles_remaining.assign(n, -1);
+        result.assign(n, 0.0);
+        ready_to_writeback.assign(n, false);
+    }
+    int size() const { return (int)busy.size(); }
+};
+
+// Categorias da pilha de CPI. Cada ciclo e atribuido a exatamente uma: "base"
+// se houve commit; senao o motivo pelo qual a instrucao na cabeca do ROB
+// ainda nao pode comprometer (ou "frontend" se o ROB esta vazio).
+enum CpiCategory {
+    CPI_BASE,           // ao menos um commit no ciclo
+    CPI_FRONTEND,       // ROB vazio (inicio, fim ou janela cheia)
+    CPI_DEPENDENCY,     // cabeca esperando operando (Qj/Qk ou registrador base)
+    CPI_MEM_HAZARD,     // LOAD na cabeca esperando um STORE mais antigo
+    CPI_STORE_DATA,     // STORE na cabeca esperando o valor a gravar
+    CPI_EXEC_ADD,       // cabeca executando ADD/SUB
+    CPI_EXEC_MUL,
+    CPI_EXEC_DIV,
+    CPI_EXEC_MEM,       // cabeca acessando a memoria
+    CPI_CDB,            // cabeca concluida esperando o writeback
+    CPI_COUNT
+};
+
+const char* cpi_category_name(CpiCategory category);
+
+// Contadores de uma estacao (RS ou buffer L/S), em ciclos
+struct StationCounters {
+    long busy = 0;          // ocupada
+    long executing = 0;     // contando latencia
+    long wait_operand = 0;  // esperando operando no CDB
+    long mem_hazard = 0;    // LOAD esperando um STORE mais antigo (ordem de memoria)
+    long cdb_wait = 0;      // concluida esperando o writeback
+};
+
+// Contadores da execucao (resumo final e tabelas da varredura)
+struct SimStats {
+    long cycles = 0;
+    long committed = 0;             // pelo pipeline (sem as do fast-forward)
+    long fast_forwarded = 0;        // executadas so funcionalmente, antes do primeiro ciclo
+    bool finished = false;          // false se parou pelo limite de ciclos
+
+    // Ciclos em que o issue parou, por motivo
+    long stall_rs_add = 0;          // sem RS ADD/SUB livre
+    long stall_rs_mul = 0;          // sem RS MUL/DIV livre
+    long stall_ls = 0;              // sem buffer L/S livre
+    long stall_rob = 0;             // ROB cheio
+    long stall_window = 0;          // janela de instrucoes cheia (streaming)
+
+    // ROB e commit
+    long rob_occupancy_sum = 0;     // soma da ocupacao do ROB (para a media)
+    long rob_occupancy_max = 0;
+    long commit_width_limited = 0;  // ciclos em que o commit parou pela largura
+    long commit_active_cycles = 0;  // ciclos com ao menos um commit
+
+    // Pilha de CPI (soma = cycles) e contadores por estacao (RS seguidas dos L/S)
+    long cpi[CPI_COUNT] = {};
+    long cdb_conflicts = 0;         // estacoes prontas que perderam o CDB no ciclo
+    long cdb_broadcasts = 0;        // resultados transmitidos (soma sobre os barramentos)
+    long loads_forwarded = 0;       // LOADs que receberam o valor de um STORE em voo
+    CacheStats l1;                  // acertos e falhas por nivel (zerados sem cache)
+    CacheStats l2;
+
+    // Largura do issue
+    long issued = 0;                // instrucoes emitidas
+    long issue_width_full = 0;      // ciclos em que o issue emitiu issue_width instrucoes
+    std::vector<StationCounters> stations;
+
+    // Inicio do intervalo medido (diferente de 0 apos restaurar um checkpoint
+    // ou no fim do aquecimento)
+    long start_cycle = 0;
+    long start_committed = 0;
+    bool warmed_up = false;         // o intervalo comeca no fim do aquecimento
+
+    double ipc() const { return cycles > 0 ? (double)committed / cycles : 0.0; }
+    double interval_ipc() const {
+        return cycles > start_cycle ? (double)(committed - start_committed) / (cycles - start_cycle) : 0.0;
+    }
+};
+
+// STORE comprometido, anotado para o driver multicore (ver record_stores)
+struct StoreRecord {
+    long cycle;
+    long address;
+    double value;
+};
+
+class Simulator;
+
+// --- Observador da Simulacao (uso como biblioteca) ---
+// Registrado com Simulator::set_observer, recebe os eventos dos estagios no
+// ciclo em que acontecem. Os metodos tem corpo vazio: basta sobrescrever os de
+// interesse. Sem observador registrado o laco usa step_impl<false>, em que as
+// chamadas nem sao geradas.
+class SimObserver {
+public:
+    virtual ~SimObserver() {}
+    virtual void on_issue(const Simulator& /*sim*/, const Instruction& /*inst*/, Tag /*station*/) {}
+    // Inicio da execucao (LOAD/STORE: calculo do endereco)
+    virtual void on_execute_start(const Simulator& /*sim*/, const Instruction& /*inst*/, Tag /*station*/) {}
+    // Resultado calculado (LOAD: valor lido; STORE: valor a gravar)
+    virtual void on_execute_end(const Simulator& /*sim*/, const Instruction& /*inst*/, Tag /*station*/,
+                                double /*value*/) {}
+    virtual void on_writeback(const Simulator& /*sim*/, const Instruction& /*inst*/, Tag /*station*/,
+                              double /*value*/) {}
+    virtual void on_commit(const Simulator& /*sim*/, const Instruction& /*inst*/, double /*value*/) {}
+};
+
+class Simulator {
+private:
+    SimConfig config;
+    RunMode mode;
+    bool verbose;   // true apenas no modo interativo (log por ciclo)
+    bool print_cycles;          // cada ciclo limpa a tela e imprime o quadro inteiro (interativo sem terminal)
+    long cycle;
+    long pc;                    // sequencia da proxima instrucao a emitir
+    bool simulation_complete;
+    bool halted;                // parou antes do fim (limite de ciclos ou travamento)
+    bool started;               // limite de ciclos e checkpoints ja calculados
+    long committed_inst_count;
+    SimObserver* observer;      // nullptr = nenhum
+    long pause_cycle;           // run_until: o salto de ciclos nao passa daqui (0 = sem pausa)
+    long warmup_end;            // aquecimento: o intervalo medido comeca neste commit (0 = nenhum)
+
+    // Janela circular de instrucoes: a instrucao de sequencia s fica em
+    // inst_window[s % inst_window.size()]. Com o programa inteiro carregado a
+    // janela tem o tamanho do programa; em modo streaming ela tem tamanho fixo,
+    // as instrucoes sao buscadas da fonte sob demanda e o slot e reaproveitado
+    // depois do commit.
+    std::vector<Instruction> inst_window;
+    std::unique_ptr<InstructionSource> source;
+    long fetched;               // instrucoes ja trazidas da fonte
+    bool source_done;           // fonte esgotada (total de instrucoes conhecido)
+    bool window_elastic;        // a janela cresce em vez de parar o issue (programa compartilhado)
+    long roi_seq;               // marcador #@roi do programa carregado inteiro (-1 = nenhum)
+    uint64_t trace_bytes;       // tamanho do trace aberto em streaming (conferido ao restaurar)
+    std::string trace_name;     // nas mensagens de erro do trace
+    bool bad_trace;             // registrador fora dos bancos no trace lido sob demanda
+    std::ofstream timing_out;   // destino das linhas de tempo (CSV) no commit
+    std::ofstream counters_out; // destino dos contadores e da pilha de CPI (JSON) no fim
+    RS_Table rs;      // slots [0, config.add_rs) = Add, depois Mult
+    LS_Table ls;
+    ReorderBuffer rob;
+    StoreQueue store_queue;     // STOREs em voo (emitidos ate o commit), indexados por endereco
+    CacheHierarchy caches;      // latencia dos acessos L/S (desligada: mem_latency fixa)
+
+    SimStats stats;
+    bool issue_progress;        // o issue emitiu uma instrucao no ciclo atual
+    long* issue_stall;          // contador de parada do issue no ciclo atual (nullptr = nenhuma)
+    long cycle_limit;           // ultimo ciclo permitido (0 = sem limite), relativo ao inicio
+
+    // Checkpoints periodicos: 'checkpoint_prefix'.<ciclo>.ckpt a cada 'checkpoint_every' ciclos
+    long checkpoint_every;
+    long next_checkpoint;       // 0 = nenhum agendado
+    std::string checkpoint_prefix;
+
+    // Log de eventos: na tela (modo interativo) ou em arquivo binario (--log-out).
+    // Os estagios so testam log_events; com o log desligado nada mais e feito.
+    EventLog event_log;
+    bool log_events;            // um registro por evento dos estagios (log_level = events)
+    bool log_summary;           // um registro por ciclo (log_level = summary)
+
+    // STOREs comprometidos desde o ultimo take_stores (so com record_stores ligado)
+    bool recording_stores;
+    std::vector<StoreRecord> store_records;
+
+    // Listas de espera por tag: waiters[tag] guarda os consumidores aguardando
+    // aquele produtor. Como a estacao pode ser reaproveitada antes do commit do
+    // produtor anterior, cada espera guarda tambem a sequencia do produtor.
+    struct Waiter {
+        int consumer;   // tag_do_consumidor * 2 + operando (0 = Qj/base, 1 = Qk/valor do STORE)
+        long producer;  // sequencia da instrucao produtora
+    };
+    std::vector<std::vector<Waiter>> waiters;
+    std::vector<int> cdb_candidates;    // estacoes prontas no writeback do ciclo (tag - 1)
+
+    std::vector<double> reg_file;   // indexado pelo numero decodificado do registrador
+    std::vector<Tag> reg_status;
+    std::vector<long> reg_producer; // sequencia da ultima instrucao que renomeou o registrador (-1 = nenhuma)
+    PagedMemory memory;
+
+    template <bool Observed> bool step_impl();
+    template <bool Observed> void commit();
+    template <bool Observed> void issue();
+    template <bool Observed> bool issue_one();
+    template <bool Observed> void execute();
+    template <bool Observed> void writeback();
+    template <bool Observed> void broadcast_rs(int slot);
+    template <bool Observed> void broadcast_ls(int slot);
+    void begin();
+    void update_stats();
+    void finish();
+    bool check_completion();
+    bool skip_idle_cycles();
+    void sample_counters(long weight);
+    CpiCategory blame_rob_head();
+    bool fetch_next();
+    bool check_fetched(const DecodedInst& code, long seq);
+    void store_fetched(const DecodedInst& code);
+    bool load_all(InstructionSource& parser, const std::string& name);
+    void grow_window();
+    Instruction& inst_at(long seq) { return inst_window[seq % inst_window.size()]; }
+    const Instruction& inst_at(long seq) const { return inst_window[seq % inst_window.size()]; }
+    void write_timing_row(const Instruction& inst);
+    EventLogHeader log_header() const;
+    void start_log();
+    LogEvent event(EventKind kind, Tag station = NO_TAG) const {
+        LogEvent e = LogEvent();
+        e.cycle = cycle;
+        e.kind = kind;
+        e.station = station;
+        return e;
+    }
+    int op_latency(OpCode op) const;
+
+    void print_state(std::ostream& out);
+    void print_final_registers();
+    Tag rs_tag(int slot) const { return slot + 1; }
+    Tag ls_tag(int slot) const { return rs.size() + slot + 1; }
+    void print_memory_state();
+    // Linhas de status das instrucoes de sequencia [first, last)
+    void print_instruction_status(std::ostream& out, long first, long last);
+    void print_summary();
+    void print_rob_stats();
+    void write_counters_json(std::ostream& out);
+
+    // --- Fast-forward Funcional (fastforward.cpp) ---
+    // Executa o inicio do trace em ordem de programa (config.fast_forward) e
+    // deixa o pipeline vazio na instrucao seguinte
+    void fast_forward();
+    void end_warmup();
+
+    // --- Modo Interativo em Terminal (terminal.cpp) ---
+    // Com entrada e saida em terminal, run() redesenha so as linhas que
+    // mudaram e aceita comandos para avancar varios ciclos de uma vez
+    void run_terminal();
+    void build_frame(std::vector<std::string>& frame, const std::string& title,
+                     const std::string& message, int height);
+
+    bool load_blocked(int slot);
+    long forwarding_store(int slot);
+    double store_data(long number);
+    void rebuild_store_queue();
+    void rename_source(int reg, Tag consumer, int operand, double& value, Tag& producer);
+    void rename_dest(int reg, Tag tag, long seq);
+    void add_waiter(Tag producer, long producer_seq, Tag consumer, int operand);
+    void wake_waiters(Tag tag, long producer_seq, double value);
+
+public:
+    explicit Simulator(const SimConfig& config, RunMode mode = MODE_INTERACTIVE);
+    bool load_instructions(const std::string& filename);
+    bool init_memory();
+    bool open_stream(const std::string& filename, int window_size);
+    // Os tres falham se o trace usa registradores fora dos bancos (f_regs, r_regs)
+    bool open_program(std::shared_ptr<const Program> program);
+    // Programa em texto ja em memoria (mesma gramatica dos arquivos de trace)
+    bool load_text(const std::string& text, const std::string& name = "<memoria>");
+    bool open_timing_output(const std::string& filename);
+    // Simulacao completa com a saida do modo escolhido (interativo: espera ENTER a cada ciclo)
+    void run();
+    const SimStats& get_stats() const { return stats; }
+
+    // --- Execucao Passo a Passo (biblioteca) ---
+    // Use MODE_SILENT para nao escrever nada na saida padrao. Cada chamada
+    // retorna false quando a simulacao acabou (ou parou pelo limite de
+    // ciclos / travou); get_stats() vale a qualquer momento.
+    bool step();                        // um ciclo (ou um salto de ciclos ociosos)
+    bool run_until(long target_cycle);  // para com current_cycle() == target_cycle
+    bool run_to_completion();           // true se todas as instrucoes comprometeram
+    void set_observer(SimObserver* obs) { observer = obs; }
+
+    // --- Consulta do Estado (somente leitura) ---
+    long current_cycle() const { return cycle; }
+    bool done() const { return simulation_complete || halted; }
+    long issued_count() const { return pc; }
+    long committed_count() const { return committed_inst_count; }
+    // Instrucao de sequencia 'seq' com estado e tempos; nullptr se ainda nao
+    // foi buscada ou se o slot da janela ja foi reaproveitado (streaming)
+    const Instruction* instruction(long seq) const;
+    const RS_Table& reservation_stations() const { return rs; }
+    const LS_Table& load_store_buffers() const { return ls; }
+    const ReorderBuffer& reorder_buffer() const { return rob; }
+    double register_value(int index) const { return reg_file[index]; }
+    Tag register_tag(int index) const { return reg_status[index]; }   // NO_TAG = valor pronto
+    double memory_value(long address) const { return memory.peek(address); }
+    const SimConfig& get_config() const { return config; }
+    std::string tag_name(Tag tag) const;
+    static std::string get_register_name(int index);
+    // 'f_used'/'r_used' registradores (ver registers_used) cabem nos bancos
+    // da configuracao? Se nao, reporta em std::cerr, identificando 'where'
+    static bool fits_register_banks(const SimConfig& config, int f_used, int r_used, const std::string& where);
+    // Trace lido sob demanda com registrador fora dos bancos: a simulacao parou ali
+    bool trace_failed() const { return bad_trace; }
+    bool open_counters_output(const std::string& filename);
+    // Grava o log de eventos (nivel config.log_level) em 'filename', por uma thread de escrita
+    bool open_event_log(const std::string& filename);
+
+    // --- Memoria Compartilhada (multicore.cpp) ---
+    // Cada nucleo simula sobre a propria memoria; os STOREs comprometidos sao
+    // anotados e, na fronteira de cada quantum, o driver aplica em todos os
+    // nucleos os STOREs de todos, na mesma ordem.
+    void record_stores(bool on) { recording_stores = on; }
+    void take_stores(std::vector<StoreRecord>& out) {
+        out.clear();
+        out.swap(store_records);
+    }
+    void write_memory(long address, double value) { memory.write(address, value); }
+    std::vector<std::pair<long, double>> written_memory() const { return memory.written_cells(); }
+
+    // --- Checkpoints (checkpoint.cpp) ---
+    // O estado completo (ciclo, PC, estacoes, ROB, registradores, memoria,
+    // instrucoes em voo, contadores e posicao no trace) e gravado em binario.
+    // So funciona com o trace lido sob demanda (open_stream), para que a
+    // restauracao reposicione o arquivo direto no byte seguinte.
+    void schedule_checkpoints(long every, const std::string& prefix);
+    bool save_checkpoint(const std::string& filename);
+    // Substitui init_memory/open_stream: restaura o estado e reabre 'trace'
+    bool restore_checkpoint(const std::string& filename, const std::string& trace);
+};
+
+#endif // SIMULATOR_H
@@ -0,0 +1,345 @@
+#include "sweep.h"
+#include "simulator.h"
+#include <thread>
+#include <mutex>
+#include <deque>
+#include <atomic>
+#include <chrono>
+#include <iomanip>
+
+// --- Pool de Threads ---
+
+WorkStealingPool::WorkStealingPool(int threads) : threads(threads < 1 ? 1 : threads) {}
+
+namespace {
+
+// Fila de uma thread, alinhada para que filas vizinhas nao dividam linha de cache
+struct alignas(64) WorkQueue {
+    std::mutex lock;
+    std::deque<size_t> jobs;
+};
+
+}
+
+void WorkStealingPool::run(size_t count, const std::function<void(size_t)>& job) {
+    int n = (int)std::min<size_t>(threads, std::max<size_t>(count, 1));
+    std::vector<WorkQueue> queues(n);
+    for (size_t i = 0; i < count; ++i) queues[i % n].jobs.push_back(i);
+
+    auto worker = [&](int self) {
+        for (;;) {
+            size_t index = 0;
+            bool found = false;
+
+            // Primeiro a propria fila (pelo fim)...
+            {
+                std::lock_guard<std::mutex> guard(queues[self].lock);
+                if (!queues[self].jobs.empty()) {
+                    index = queues[self].jobs.back();
+                    queues[self].jobs.pop_back();
+                    found = true;
+                }
+            }
+            // ...depois rouba do inicio das outras
+            for (int k = 1; k < n && !found; ++k) {
+                WorkQueue& victim = queues[(self + k) % n];
+                std::lock_guard<std::mutex> guard(victim.lock);
+                if (!victim.jobs.empty()) {
+                    index = victim.jobs.front();
+                    victim.jobs.pop_front();
+                    found = true;
+                }
+            }
+            // Nenhuma tarefa sobrando: as filas so diminuem, entao acabou
+            if (!found) return;
+            job(index);
+        }
+    };
+
+    std::vector<std::thread> pool;
+    for (int t = 1; t < n; ++t) pool.emplace_back(worker, t);
+    worker(0);
+    for (std::thread& t : pool) t.join();
+}
+
+
+// --- Varredura ---
+
+namespace {
+
+// Eixo da varredura: chave da configuracao e os valores a testar
+struct Axis {
+    std::string key;
+    std::vector<std::string> values;
+};
+
+std::string trim(const std::string& s) {
+    size_t b = s.find_first_not_of(" \t\r");
+    if (b == std::string::npos) return "";
+    size_t e = s.find_last_not_of(" \t\r");
+    return s.substr(b, e - b + 1);
+}
+
+// "chave = v1, v2, v3" -> Axis
+bool parse_axis(const std::string& text, const std::string& where, Axis& axis) {
+    size_t eq = text.find('=');
+    if (eq == std::string::npos) {
+        std::cerr << where << ": esperado 'chave = v1, v2, ...': " << trim(text) << std::endl;
+        return false;
+    }
+    axis.key = trim(text.substr(0, eq));
+    axis.values.clear();
+    std::string rest = text.substr(eq + 1);
+    size_t start = 0;
+    for (;;) {
+        size_t comma = rest.find(',', start);
+        std::string value = trim(rest.substr(start, comma == std::string::npos ? std::string::npos : comma - start));
+        if (value.empty()) {
+            std::cerr << where << ": valor vazio na lista de " << axis.key << std::endl;
+            return false;
+        }
+        axis.values.push_back(value);
+        if (comma == std::string::npos) break;
+        start = comma + 1;
+    }
+    return true;
+}
+
+bool load_grid(const std::string& filename, std::vector<Axis>& axes) {
+    std::ifstream file(filename);
+    if (!file) {
+        std::cerr << "Erro ao abrir arquivo de varredura: " << filename << std::endl;
+        return false;
+    }
+    std::string line;
+    int line_no = 0;
+    while (std::getline(file, line)) {
+        ++line_no;
+        size_t hash = line.find('#');
+        if (hash != std::string::npos) line.erase(hash);
+        if (trim(line).empty()) continue;
+        Axis axis;
+        if (!parse_axis(line, filename + ":" + std::to_string(line_no), axis)) return false;
+        axes.push_back(axis);
+    }
+    return true;
+}
+
+std::string json_string(const std::string& s) {
+    std::string out = "\"";
+    for (char c : s) {
+        if (c == '"' || c == '\\') out += '\\';
+        out += c;
+    }
+    return out + "\"";
+}
+
+std::string csv_field(const std::string& s) {
+    if (s.find_first_of(",\"\n") == std::string::npos) return s;
+    std::string out = "\"";
+    for (char c : s) {
+        if (c == '"') out += '"';
+        out += c;
+    }
+    return out + "\"";
+}
+
+void print_sweep_usage() {
+    std::cerr << "Uso: simulador sweep [opcoes] <trace> [<trace> ...]" << std::endl;
+    std::cerr << "  --grid ARQ           eixos da varredura, um por linha: chave = v1, v2, ..." << std::endl;
+    std::cerr << "  --vary CHAVE=V1,V2   eixo da varredura na linha de comando (pode repetir)" << std::endl;
+    std::cerr << "  --config ARQ         configuracao base (arquivo chave = valor)" << std::endl;
+    std::cerr << "  --set CHAVE=VALOR    sobrescreve uma chave da configuracao base" << std::endl;
+    std::cerr << "  --threads N          numero de threads (padrao: todos os nucleos)" << std::endl;
+    std::cerr << "  --out ARQ            arquivo de saida (padrao: saida padrao)" << std::endl;
+    std::cerr << "  --format csv|json    formato da tabela (padrao: pela extensao de --out, senao csv)" << std::endl;
+    std::cerr << "Ex: simulador sweep --vary add_rs=2,3,4 --vary div_latency=20,40 --out res.csv a.txt b.txt" << std::endl;
+}
+
+}
+
+int run_sweep(int argc, char* argv[]) {
+    std::vector<std::string> traces;
+    std::vector<Axis> axes;
+    std::vector<std::string> overrides;
+    const char* config_file = nullptr;
+    std::string out_file;
+    std::string format;
+    int threads = (int)std::thread::hardware_concurrency();
+
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        bool takes_value = arg == "--grid" || arg == "--vary" || arg == "--config" || arg == "--set"
+                        || arg == "--threads" || arg == "--out" || arg == "--format";
+        if (takes_value) {
+            if (i + 1 >= argc) {
+                std::cerr << "Opcao " << arg << " exige um valor" << std::endl;
+                return EXIT_FAILURE;
+            }
+            std::string value = argv[++i];
+            if (arg == "--grid") {
+                if (!load_grid(value, axes)) return EXIT_FAILURE;
+            } else if (arg == "--vary") {
+                Axis axis;
+                if (!parse_axis(value, "linha de comando", axis)) return EXIT_FAILURE;
+                axes.push_back(axis);
+            } else if (arg == "--config") config_file = argv[i];
+            else if (arg == "--set") overrides.push_back(value);
+            else if (arg == "--out") out_file = value;
+            else if (arg == "--format") format = value;
+            else {
+                threads = std::atoi(value.c_str());
+                if (threads < 1) {
+                    std::cerr << "Valor invalido para --threads: " << value << std::endl;
+                    return EXIT_FAILURE;
+                }
+            }
+        } else if (arg == "--help") {
+            print_sweep_usage();
+            return EXIT_SUCCESS;
+        } else if (!arg.empty() && arg[0] == '-') {
+            std::cerr << "Opcao desconhecida: " << arg << std::endl;
+            print_sweep_usage();
+            return EXIT_FAILURE;
+        } else {
+            traces.push_back(arg);
+        }
+    }
+    if (traces.empty()) {
+        print_sweep_usage();
+        return EXIT_FAILURE;
+    }
+    if (format.empty()) {
+        format = (out_file.size() > 5 && out_file.compare(out_file.size() - 5, 5, ".json") == 0) ? "json" : "csv";
+    }
+    if (format != "csv" && format != "json") {
+        std::cerr << "Formato desconhecido: " << format << " (use csv ou json)" << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    // Configuracao base
+    SimConfig base;
+    if (config_file != nullptr && !base.load_file(config_file)) return EXIT_FAILURE;
+    for (const std::string& assignment : overrides) {
+        if (!base.apply(assignment, "linha de comando")) return EXIT_FAILURE;
+    }
+
+    // Produto cartesiano dos eixos (o primeiro eixo varia mais devagar).
+    // Cada combinacao e validada aqui, antes de iniciar as threads.
+    size_t combinations = 1;
+    for (const Axis& axis : axes) combinations *= axis.values.size();
+    std::vector<SimConfig> configs;
+    std::vector<std::vector<size_t>> choices;
+    configs.reserve(combinations);
+    for (size_t c = 0; c < combinations; ++c) {
+        SimConfig config = base;
+        std::vector<size_t> choice(axes.size());
+        size_t rest = c;
+        for (size_t a = axes.size(); a-- > 0;) {
+            choice[a] = rest % axes[a].values.size();
+            rest /= axes[a].values.size();
+        }
+        for (size_t a = 0; a < axes.size(); ++a) {
+            if (!config.apply(axes[a].key + "=" + axes[a].values[choice[a]], "varredura")) return EXIT_FAILURE;
+        }
+        if (!config.validate("varredura, combinacao " + std::to_string(c))) return EXIT_FAILURE;
+        configs.push_back(config);
+        choices.push_back(choice);
+    }
+
+    WorkStealingPool pool(threads);
+    auto start = std::chrono::steady_clock::now();
+
+    // Cada trace e lido e decodificado uma unica vez
+    std::vector<std::shared_ptr<const Program>> programs(traces.size());
+    std::atomic<bool> failed(false);
+    pool.run(traces.size(), [&](size_t t) {
+        std::shared_ptr<Program> program(new Program());
+        if (!load_program(traces[t], *program)) failed = true;
+        programs[t] = program;
+    });
+    if (failed) return EXIT_FAILURE;
+
+    // Uma simulacao por (trace, configuracao)
+    size_t jobs = traces.size() * configs.size();
+    std::vector<SimStats> results(jobs);
+    pool.run(jobs, [&](size_t j) {
+        size_t t = j / configs.size();
+        size_t c = j % configs.size();
+        Simulator sim(configs[c], MODE_SILENT);
+        if (!sim.init_memory()) {
+            failed = true;
+            return;
+        }
+        if (!sim.open_program(programs[t])) {
+            failed = true;
+            return;
+        }
+        sim.run();
+        results[j] = sim.get_stats();
+    });
+    if (failed) return EXIT_FAILURE;
+
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    // --- Tabela de Resultados ---
+    std::ofstream file;
+    if (!out_file.empty()) {
+        file.open(out_file);
+        if (!file) {
+            std::cerr << "Erro ao criar arquivo de saida: " << out_file << std::endl;
+            return EXIT_FAILURE;
+        }
+    }
+    std::ostream& out = out_file.empty() ? std::cout : file;
+
+    const char* counters[] = {"stall_rs_add", "stall_rs_mul", "stall_ls", "stall_rob",
+                              "stall_window", "commit_width_limited", "issue_width_full", "cdb_conflicts",
+                              "l1_hits", "l1_misses", "l2_hits", "l2_misses"};
+    if (format == "csv") {
+        out << "trace,config";
+        for (const Axis& axis : axes) out << "," << csv_field(axis.key);
+        out << ",instructions,committed,cycles,ipc,finished";
+        for (const char* name : counters) out << "," << name;
+        out << "\n";
+    } else {
+        out << "[\n";
+    }
+
+    out << std::fixed << std::setprecision(4);
+    for (size_t j = 0; j < jobs; ++j) {
+        size_t t = j / configs.size();
+        size_t c = j % configs.size();
+        const SimStats& r = results[j];
+        long values[] = {r.stall_rs_add, r.stall_rs_mul, r.stall_ls, r.stall_rob,
+                         r.stall_window, r.commit_width_limited, r.issue_width_full, r.cdb_conflicts,
+                         r.l1.hits, r.l1.misses, r.l2.hits, r.l2.misses};
+
+        if (format == "csv") {
+            out << csv_field(traces[t]) << "," << c;
+            for (size_t a = 0; a < axes.size(); ++a) out << "," << csv_field(axes[a].values[choices[c][a]]);
+            out << "," << programs[t]->size << "," << r.committed << "," << r.cycles
+                << "," << r.ipc() << "," << (r.finished ? 1 : 0);
+            for (long v : values) out << "," << v;
+            out << "\n";
+        } else {
+            out << "  {\"trace\": " << json_string(traces[t]) << ", \"config\": " << c;
+            for (size_t a = 0; a < axes.size(); ++a) {
+                out << ", " << json_string(axes[a].key) << ": " << json_string(axes[a].values[choices[c][a]]);
+            }
+            out << ", \"instructions\": " << programs[t]->size << ", \"committed\": " << r.committed
+                << ", \"cycles\": " << r.cycles << ", \"ipc\": " << r.ipc()
+                << ", \"finished\": " << (r.finished ? "true" : "false");
+            for (size_t k = 0; k < sizeof(values) / sizeof(values[0]); ++k) {
+                out << ", \"" << counters[k] << "\": " << values[k];
+            }
+            out << "}" << (j + 1 < jobs ? "," : "") << "\n";
+        }
+    }
+    if (format == "json") out << "]\n";
+
+    std::cerr << jobs << " simulacoes (" << traces.size() << " traces x " << configs.size()
+              << " configuracoes) em " << std::setprecision(2) << seconds << " s com "
+              << std::min<size_t>(pool.size(), std::max<size_t>(jobs, 1)) << " threads" << std::endl;
+    return EXIT_SUCCESS;
+}
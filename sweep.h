@@ -0,0 +1,31 @@
+#ifndef SWEEP_H
+#define SWEEP_H
+
+#include <cstddef>
+#include <functional>
+
+// --- Pool de Threads com Roubo de Tarefas ---
+// Cada thread tem a propria fila de tarefas (indices 0..n-1, distribuidos em
+// rodizio), consome do fim da sua e, quando ela esvazia, rouba do inicio da
+// fila das outras. Tarefas de duracao muito diferente (ex.: latencias de DIV
+// altas) ficam balanceadas sem um contador global disputado a cada tarefa.
+class WorkStealingPool {
+public:
+    explicit WorkStealingPool(int threads);
+    int size() const { return threads; }
+
+    // Executa job(i) para todo i em [0, count) e espera o termino
+    void run(size_t count, const std::function<void(size_t)>& job);
+
+private:
+    int threads;
+};
+
+// --- Varredura do Espaco de Projeto (subcomando "sweep") ---
+// Le cada trace uma unica vez, compartilha o programa decodificado entre as
+// threads e simula todas as combinacoes de configuracao, gravando uma tabela
+// CSV ou JSON com ciclos, IPC e paradas por motivo.
+// argv[0] e o proprio "sweep". Retorna o codigo de saida do processo.
+int run_sweep(int argc, char* argv[]);
+
+#endif // SWEEP_H
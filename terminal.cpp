@@ -0,0 +1,325 @@
+#include "terminal.h"
+#include "simulator.h"
+#include <iostream>
+#include <sstream>
+#include <algorithm>
+#include <csignal>
+#include <cstdlib>
+#include <cerrno>
+#include <unistd.h>
+#include <poll.h>
+#include <sys/ioctl.h>
+
+// --- Tela ANSI ---
+
+namespace {
+
+const char* ENTER_ALT_SCREEN = "\x1b[?1049h\x1b[2J";
+const char* LEAVE_ALT_SCREEN = "\x1b[?1049l";
+
+// Ctrl+C com a tela alternativa aberta: devolve a tela normal antes de sair
+void restore_screen_on_signal(int sig) {
+    ssize_t ignored = write(STDOUT_FILENO, LEAVE_ALT_SCREEN, 8);
+    (void)ignored;
+    std::signal(sig, SIG_DFL);
+    std::raise(sig);
+}
+
+std::string move_to(size_t row, size_t col) {
+    return "\x1b[" + std::to_string(row + 1) + ";" + std::to_string(col + 1) + "H";
+}
+
+}
+
+TerminalView::TerminalView() : rows(24), cols(80), active(false), resized(true) {}
+
+TerminalView::~TerminalView() {
+    close();
+}
+
+bool TerminalView::available() {
+    return isatty(STDIN_FILENO) && isatty(STDOUT_FILENO);
+}
+
+void TerminalView::open() {
+    std::cout << ENTER_ALT_SCREEN << std::flush;
+    std::signal(SIGINT, restore_screen_on_signal);
+    std::signal(SIGTERM, restore_screen_on_signal);
+    active = true;
+    resized = true;
+    update_size();
+}
+
+void TerminalView::close() {
+    if (!active) return;
+    std::cout << LEAVE_ALT_SCREEN << std::flush;
+    std::signal(SIGINT, SIG_DFL);
+    std::signal(SIGTERM, SIG_DFL);
+    active = false;
+    shown.clear();
+}
+
+void TerminalView::update_size() {
+    struct winsize ws;
+    if (ioctl(STDOUT_FILENO, TIOCGWINSZ, &ws) != 0 || ws.ws_row < 2 || ws.ws_col == 0) return;
+    if (ws.ws_row != rows || ws.ws_col != cols) resized = true;
+    rows = ws.ws_row;
+    cols = ws.ws_col;
+}
+
+int TerminalView::height() {
+    update_size();
+    return rows;
+}
+
+void TerminalView::present(const std::vector<std::string>& frame) {
+    update_size();
+    std::string out;
+    if (resized) {
+        out += "\x1b[2J";
+        shown.clear();
+        resized = false;
+    }
+
+    // Cabe em rows - 1 linhas; sem espaco, as do fim saem mas o prompt fica
+    size_t limit = (size_t)rows - 1;
+    std::vector<std::string> lines;
+    lines.reserve(std::min(frame.size(), limit));
+    for (size_t r = 0; r < frame.size() && lines.size() < limit; ++r) {
+        size_t source = (lines.size() + 1 == limit) ? frame.size() - 1 : r;
+        lines.push_back(frame[source].substr(0, (size_t)cols));
+    }
+
+    // O prompt sempre e reescrito: a linha guarda o que foi digitado
+    for (size_t r = 0; r < lines.size(); ++r) {
+        bool prompt = (r + 1 == lines.size());
+        if (!prompt && r < shown.size() && shown[r] == lines[r]) continue;
+        out += move_to(r, 0) + lines[r] + "\x1b[K";
+    }
+    // Linhas do quadro anterior alem do atual, e a que recebeu o eco do ENTER
+    for (size_t r = lines.size(); r < std::max(shown.size(), lines.size() + 1) && r < (size_t)rows; ++r) {
+        out += move_to(r, 0) + "\x1b[K";
+    }
+    if (!lines.empty()) out += move_to(lines.size() - 1, lines.back().size());
+
+    std::cout << out << std::flush;
+    shown.swap(lines);
+}
+
+
+// --- Modo Interativo em Terminal ---
+
+namespace {
+
+const char* COMMAND_HELP = "ENTER: 1 ciclo | N: N ciclos | e: proxima mudanca | r: roda ate ENTER | c: continua sem exibir | q: sai";
+
+// Ha uma linha digitada esperando (sem bloquear)?
+bool input_waiting() {
+    if (std::cin.rdbuf()->in_avail() > 0) return true;
+    struct pollfd fd = {STDIN_FILENO, POLLIN, 0};
+    return poll(&fd, 1, 0) > 0;
+}
+
+// Quebra 'text' em linhas (sem a quebra final)
+void split_lines(const std::string& text, std::vector<std::string>& lines) {
+    size_t start = 0;
+    while (start < text.size()) {
+        size_t end = text.find('\n', start);
+        if (end == std::string::npos) end = text.size();
+        lines.push_back(text.substr(start, end - start));
+        start = end + 1;
+    }
+}
+
+// Comando "e": avisa quando alguma instrucao muda de estado, repassando os
+// eventos ao observador que ja estava registrado
+class ChangeWatcher : public SimObserver {
+public:
+    explicit ChangeWatcher(SimObserver* next) : changed(false), next(next) {}
+    bool changed;
+
+    void on_issue(const Simulator& sim, const Instruction& inst, Tag station) override {
+        changed = true;
+        if (next) next->on_issue(sim, inst, station);
+    }
+    void on_execute_start(const Simulator& sim, const Instruction& inst, Tag station) override {
+        changed = true;
+        if (next) next->on_execute_start(sim, inst, station);
+    }
+    void on_execute_end(const Simulator& sim, const Instruction& inst, Tag station, double value) override {
+        changed = true;
+        if (next) next->on_execute_end(sim, inst, station, value);
+    }
+    void on_writeback(const Simulator& sim, const Instruction& inst, Tag station, double value) override {
+        changed = true;
+        if (next) next->on_writeback(sim, inst, station, value);
+    }
+    void on_commit(const Simulator& sim, const Instruction& inst, double value) override {
+        changed = true;
+        if (next) next->on_commit(sim, inst, value);
+    }
+
+private:
+    SimObserver* next;
+};
+
+}
+
+// Quadro de um ciclo: titulo, eventos, instrucoes visiveis, estacoes e prompt.
+// So as instrucoes que cabem na tela sao formatadas, a partir da mais antiga
+// ainda no ROB.
+void Simulator::build_frame(std::vector<std::string>& frame, const std::string& title,
+                            const std::string& message, int height) {
+    frame.clear();
+    frame.push_back(title);
+
+    std::vector<std::string> rendered, events;
+    event_log.render_pending(rendered);
+    for (const std::string& text : rendered) {
+        std::vector<std::string> lines;
+        split_lines(text, lines);
+        for (const std::string& line : lines) {
+            if (!line.empty() && line != title) events.push_back(line);
+        }
+    }
+    size_t max_events = (size_t)std::max(3, height / 4);
+    if (events.size() > max_events) {
+        size_t hidden = events.size() - (max_events - 1);
+        events.resize(max_events - 1);
+        events.push_back("  ... +" + std::to_string(hidden) + " eventos");
+    }
+    frame.insert(frame.end(), events.begin(), events.end());
+
+    std::ostringstream state;
+    print_state(state);
+    std::vector<std::string> state_lines;
+    split_lines(state.str(), state_lines);
+
+    std::vector<std::string> footer;
+    if (!message.empty()) footer.push_back(message);
+    footer.push_back("");
+    footer.push_back(COMMAND_HELP);
+    footer.push_back("> ");
+
+    // Janela de instrucoes: o que sobra da tela, sem o cabecalho da tabela (4 linhas) e a linha de posicao
+    long first_resident = std::max(0L, fetched - (long)inst_window.size());
+    long resident = fetched - first_resident;
+    long room = (long)height - 1 - (long)(frame.size() + state_lines.size() + footer.size()) - 5;
+    long count = std::min(resident, std::max(1L, room));
+    long first = std::max(first_resident, rob.head - 1);
+    if (first + count > fetched) first = std::max(first_resident, fetched - count);
+
+    std::ostringstream status;
+    print_instruction_status(status, first, first + count);
+    split_lines(status.str(), frame);
+    if (count < resident) {
+        frame.push_back("    (instrucoes " + std::to_string(first) + " a " + std::to_string(first + count - 1) +
+                        " de " + std::to_string(first_resident) + " a " + std::to_string(fetched - 1) + ")");
+    }
+    frame.insert(frame.end(), state_lines.begin(), state_lines.end());
+    frame.insert(frame.end(), footer.begin(), footer.end());
+}
+
+void Simulator::run_terminal() {
+    TerminalView view;
+    view.open();
+    print_cycles = false;
+
+    std::string title = "--- Estado Inicial (Ciclo " + std::to_string(cycle) + ") ---";
+    std::string message;
+    std::vector<std::string> frame;
+    bool to_end = false;
+
+    for (;;) {
+        if (done()) {
+            if (message.empty()) message = "Simulacao concluida no ciclo " + std::to_string(cycle) + ".";
+            message += " ENTER mostra o resumo.";
+        }
+        build_frame(frame, title, message, view.height());
+        view.present(frame);
+
+        std::string command;
+        if (!std::getline(std::cin, command)) command = "c";     // fim da entrada: segue sem exibir
+        if (done()) break;
+        command.erase(0, command.find_first_not_of(" \t"));
+        command.erase(command.find_last_not_of(" \t\r") + 1);
+        message.clear();
+
+        long steps = 0;
+        bool to_change = false;
+        bool free_run = false;
+        if (command.empty()) {
+            steps = 1;
+        } else if (command == "e") {
+            to_change = true;
+        } else if (command == "r") {
+            free_run = true;
+        } else if (command == "c") {
+            to_end = true;
+            break;
+        } else if (command == "q") {
+            halted = true;
+            update_stats();
+            finish();
+            break;
+        } else {
+            char* end = nullptr;
+            errno = 0;
+            steps = std::strtol(command.c_str(), &end, 10);
+            if (*end != '\0' || errno != 0 || steps <= 0) {
+                message = "Comando invalido: " + command;
+                event_log.discard_pending();
+                continue;
+            }
+        }
+
+        // "r": a tela fica parada enquanto a simulacao roda, ate o proximo ENTER
+        if (free_run) {
+            build_frame(frame, title, "Rodando sem exibir a partir do ciclo " + std::to_string(cycle) +
+                                      ". ENTER pausa.", view.height());
+            view.present(frame);
+        }
+
+        // A simulacao avanca sem desenhar; o que os estagios escreveriam na
+        // saida (checkpoints, limite de ciclos) vai para a linha de mensagem
+        std::ostringstream captured;
+        std::streambuf* saved = std::cout.rdbuf(captured.rdbuf());
+        ChangeWatcher watcher(observer);
+        SimObserver* previous = observer;
+        if (to_change) observer = &watcher;
+        long target = cycle + steps;
+        bool paused = false;
+        for (long n = 0; !done() && (to_change ? !watcher.changed : free_run || cycle < target); ++n) {
+            // A entrada e consultada a cada 256 ciclos, para nao pesar no passo
+            if (free_run && (n & 255) == 0 && input_waiting()) {
+                paused = true;
+                break;
+            }
+            event_log.discard_pending();
+            step();
+        }
+        observer = previous;
+        std::cout.rdbuf(saved);
+
+        std::vector<std::string> output;
+        split_lines(captured.str(), output);
+        while (!output.empty() && output.back().empty()) output.pop_back();
+        if (!output.empty()) message = output.back();
+        if (paused) {
+            std::string ignored;
+            std::getline(std::cin, ignored);
+            if (message.empty()) message = "Pausado no ciclo " + std::to_string(cycle) + ".";
+        }
+        title = "--- CICLO " + std::to_string(cycle) + " ---";
+    }
+    view.close();
+
+    // "c": o resto roda com a saida normal, sem quadros
+    if (to_end) {
+        while (!done()) {
+            event_log.discard_pending();
+            step();
+        }
+    }
+    event_log.discard_pending();
+}
@@ -0,0 +1,41 @@
+#ifndef TERMINAL_H
+#define TERMINAL_H
+
+#include <string>
+#include <vector>
+
+// --- Tela do Modo Interativo ---
+// Guarda o quadro exibido (uma string por linha) e, a cada novo quadro,
+// reescreve com codigos ANSI de posicionamento apenas as linhas que mudaram.
+// O custo de um quadro depende do que mudou, nao do tamanho do programa.
+// Usa a tela alternativa do terminal: ao fechar, o conteudo anterior volta.
+// A ultima linha do quadro e o prompt; o cursor fica no fim dela, e o
+// quadro nunca ocupa a ultima linha da tela (o ENTER digitado nao rola a tela).
+class TerminalView {
+public:
+    TerminalView();
+    ~TerminalView();
+
+    // Entrada e saida padrao sao terminais (senao vale a saida em texto corrido)
+    static bool available();
+
+    void open();
+    void close();
+    // Linhas da tela, relidas a cada chamada (redimensionar redesenha tudo)
+    int height();
+    void present(const std::vector<std::string>& frame);
+
+private:
+    std::vector<std::string> shown;     // linhas na tela, ja cortadas na largura
+    int rows;
+    int cols;
+    bool active;
+    bool resized;       // proximo quadro desenhado do zero
+
+    void update_size();
+
+    TerminalView(const TerminalView&) = delete;
+    TerminalView& operator=(const TerminalView&) = delete;
+};
+
+#endif // TERMINAL_H
@@ -0,0 +1,559 @@
+#include "trace.h"
+#include <iostream>
+#include <cstring>
+#include <algorithm>
+#include <cctype>
+#include <climits>
+#include <cerrno>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <type_traits>
+
+// Tamanho do bloco de leitura quando o arquivo nao pode ser mapeado
+static const size_t READ_CHUNK = 1 << 20;
+
+const char* op_name(OpCode op) {
+    switch (op) {
+        case OP_ADD: return "ADD";
+        case OP_SUB: return "SUB";
+        case OP_MUL: return "MUL";
+        case OP_DIV: return "DIV";
+        case OP_LOAD: return "LOAD";
+        case OP_STORE: return "STORE";
+        default: return "";
+    }
+}
+
+FuClass fu_class(OpCode op) {
+    if (op == OP_ADD || op == OP_SUB) return FU_ADD;
+    if (op == OP_MUL || op == OP_DIV) return FU_MUL;
+    return FU_LS;
+}
+
+Program::Program() {}
+Program::~Program() {}
+
+bool load_program(const std::string& filename, Program& program) {
+    program.name = filename;
+    program.code.clear();
+    program.binary.reset();
+
+    if (is_binary_trace(filename)) {
+        std::unique_ptr<BinaryTrace> binary(new BinaryTrace());
+        if (!binary->open(filename)) return false;
+        // Validados uma vez aqui, os registros sao usados direto do mapeamento
+        const DecodedInst* first = binary->records();
+        size_t total = (size_t)binary->count();
+        size_t valid = 0;
+        while (valid < total && valid_record(first[valid])) ++valid;
+        if (valid == total) {
+            program.records = first;
+            program.size = total;
+            program.roi = binary->roi_start();
+            program.binary = std::move(binary);
+            registers_used(program.records, program.size, program.f_regs, program.r_regs);
+            return true;
+        }
+        // Arquivo com registros invalidos: copia apenas os validos (cada um reportado)
+        program.code.assign(first, first + valid);
+        DecodedInst code;
+        binary->seek(valid, 0);
+        while (binary->next(code)) program.code.push_back(code);
+        program.roi = binary->roi_start();
+    } else {
+        TraceParser parser;
+        if (!parser.open(filename)) return false;
+        program.code.reserve(parser.size_bytes() / 16);
+        DecodedInst code;
+        while (parser.next(code)) program.code.push_back(code);
+        program.code.shrink_to_fit();
+        program.roi = parser.roi_start();
+    }
+    program.records = program.code.data();
+    program.size = program.code.size();
+    registers_used(program.records, program.size, program.f_regs, program.r_regs);
+    return true;
+}
+
+void registers_used(const DecodedInst* records, size_t count, int& f_regs, int& r_regs) {
+    int used[2] = {0, 0};
+    for (size_t i = 0; i < count; ++i) {
+        int regs[] = {records[i].dest, records[i].src1, records[i].src2};
+        for (int reg : regs) {
+            if (reg < 0) continue;
+            int bank = reg >= R_REG_BASE;
+            used[bank] = std::max(used[bank], reg - bank * R_REG_BASE + 1);
+        }
+    }
+    f_regs = used[0];
+    r_regs = used[1];
+}
+
+// --- Funcoes Auxiliares de Lexico (equivalentes a \s e \w) ---
+static inline bool is_space(char c) {
+    return c == ' ' || c == '\t' || c == '\r' || c == '\v' || c == '\f';
+}
+
+static inline bool is_word(char c) {
+    return isalnum((unsigned char)c) || c == '_';
+}
+
+static inline const char* skip_spaces(const char* p, const char* e) {
+    while (p < e && is_space(*p)) ++p;
+    return p;
+}
+
+static inline const char* skip_word(const char* p, const char* e) {
+    while (p < e && is_word(*p)) ++p;
+    return p;
+}
+
+// Compara o token [p, e) com um mnemonico em maiusculas, sem diferenciar caixa
+static bool token_equals(const char* p, const char* e, const char* upper) {
+    for (; p < e; ++p, ++upper) {
+        if (*upper == '\0' || toupper((unsigned char)*p) != *upper) return false;
+    }
+    return *upper == '\0';
+}
+
+static OpCode decode_op(const char* p, const char* e) {
+    if (token_equals(p, e, "ADD")) return OP_ADD;
+    if (token_equals(p, e, "SUB")) return OP_SUB;
+    if (token_equals(p, e, "MUL")) return OP_MUL;
+    if (token_equals(p, e, "DIV")) return OP_DIV;
+    if (token_equals(p, e, "LOAD")) return OP_LOAD;
+    if (token_equals(p, e, "STORE")) return OP_STORE;
+    return OP_NONE;
+}
+
+// Decodifica "Fn"/"Rn" no indice do banco; -1 se invalido
+int decode_register(const char* p, const char* e) {
+    if (e - p < 2 || e - p > 4) return -1;
+    char bank = (char)toupper((unsigned char)*p);
+    if (bank != 'F' && bank != 'R') return -1;
+    int n = 0;
+    for (++p; p < e; ++p) {
+        if (!isdigit((unsigned char)*p)) return -1;
+        n = n * 10 + (*p - '0');
+    }
+    if (n >= MAX_BANK_REGS) return -1;
+    return (bank == 'F') ? n : R_REG_BASE + n;
+}
+
+
+// --- Abertura / Fechamento ---
+
+TraceParser::TraceParser()
+    : fd(-1), map_base(nullptr), file_size(0), cur(nullptr), end(nullptr),
+      buffer_offset(0), eof(false), line_no(0), errors(0), returned(0), roi(-1) {}
+
+TraceParser::~TraceParser() {
+    close();
+}
+
+bool TraceParser::open(const std::string& filename) {
+    close();
+    name = filename;
+    fd = ::open(filename.c_str(), O_RDONLY);
+    if (fd < 0) {
+        std::cerr << "Erro ao abrir arquivo de instrucoes: " << filename << std::endl;
+        return false;
+    }
+
+    struct stat st;
+    if (fstat(fd, &st) == 0 && S_ISREG(st.st_mode)) {
+        file_size = (size_t)st.st_size;
+        if (file_size == 0) {
+            eof = true;
+            return true;
+        }
+        void* m = mmap(nullptr, file_size, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (m != MAP_FAILED) {
+            madvise(m, file_size, MADV_SEQUENTIAL);
+            map_base = (const char*)m;
+            cur = map_base;
+            end = map_base + file_size;
+            eof = true;
+            return true;
+        }
+    }
+
+    // Nao e um arquivo regular (pipe, terminal): leitura em blocos grandes
+    buffer.resize(READ_CHUNK);
+    cur = end = buffer.data();
+    return true;
+}
+
+void TraceParser::open_text(const std::string& text, const std::string& filename) {
+    close();
+    name = filename;
+    buffer.assign(text.begin(), text.end());
+    file_size = buffer.size();
+    cur = buffer.data();
+    end = cur + buffer.size();
+    eof = true;
+}
+
+void TraceParser::close() {
+    if (map_base) munmap((void*)map_base, file_size);
+    if (fd >= 0) ::close(fd);
+    fd = -1;
+    map_base = nullptr;
+    file_size = 0;
+    cur = end = nullptr;
+    buffer.clear();
+    buffer_offset = 0;
+    eof = false;
+    line_no = 0;
+    errors = 0;
+    returned = 0;
+    roi = -1;
+}
+
+// Move o trecho ainda nao consumido para o inicio do buffer e le mais um bloco.
+// Retorna false quando o arquivo acabou.
+bool TraceParser::refill() {
+    size_t pending = end - cur;
+    buffer_offset += (uint64_t)(cur - buffer.data());
+    if (pending > 0 && cur != buffer.data()) memmove(buffer.data(), cur, pending);
+    if (pending == buffer.size()) buffer.resize(buffer.size() * 2); // linha maior que o bloco
+
+    ssize_t n;
+    do {
+        n = read(fd, buffer.data() + pending, buffer.size() - pending);
+    } while (n < 0 && errno == EINTR);
+
+    cur = buffer.data();
+    end = cur + pending;
+    if (n <= 0) {
+        eof = true;
+        return false;
+    }
+    end += n;
+    return true;
+}
+
+
+// --- Posicao (checkpoints) ---
+
+bool TraceParser::tell(uint64_t& offset, int& line) const {
+    if (fd < 0) return false;
+    offset = map_base ? (uint64_t)(cur - map_base) : buffer_offset + (uint64_t)(cur - buffer.data());
+    line = line_no;
+    return true;
+}
+
+bool TraceParser::seek(uint64_t offset, int line) {
+    if (fd < 0 || offset > file_size) return false;
+    if (map_base == nullptr) return file_size == 0 && offset == 0;  // pipes nao voltam
+    cur = map_base + offset;
+    line_no = line;
+    return true;
+}
+
+
+// --- Decodificacao ---
+
+bool TraceParser::next(DecodedInst& out) {
+    for (;;) {
+        const char* nl = (cur < end) ? (const char*)memchr(cur, '\n', end - cur) : nullptr;
+        if (nl == nullptr) {
+            if (!eof && refill()) continue;
+            if (cur >= end) return false;
+            nl = end; // ultima linha sem '\n'
+        }
+
+        const char* line = cur;
+        cur = (nl < end) ? nl + 1 : end;
+        ++line_no;
+
+        const char* e = (const char*)memchr(line, '#', nl - line);
+        if (e == nullptr) e = nl;
+        else if (roi < 0 && nl - e >= 5 && memcmp(e, "#@roi", 5) == 0) roi = returned;
+
+        int r = parse_line(line, e, out) ? 1 : 0;
+        if (r) {
+            ++returned;
+            return true;
+        }
+
+        // Linha vazia ou so com comentario nao e erro
+        if (skip_spaces(line, e) == e) continue;
+
+        const char* shown_end = e;
+        while (shown_end > line && is_space(shown_end[-1])) --shown_end;
+        std::cerr << name << ":" << line_no << ": formato invalido de instrucao (ignorando): "
+                  << std::string(line, shown_end) << std::endl;
+        ++errors;
+    }
+}
+
+// Decodifica uma linha [p, e) ja sem comentario
+bool TraceParser::parse_line(const char* p, const char* e, DecodedInst& out) {
+    p = skip_spaces(p, e);
+
+    // Mnemonico seguido de pelo menos um espaco
+    const char* tok = p;
+    p = skip_word(p, e);
+    if (p == tok || p == e || !is_space(*p)) return false;
+    OpCode op = decode_op(tok, p);
+    if (op == OP_NONE) return false;
+    p = skip_spaces(p, e);
+
+    // Primeiro registrador e a virgula
+    tok = p;
+    p = skip_word(p, e);
+    int dest = decode_register(tok, p);
+    if (dest < 0) return false;
+    p = skip_spaces(p, e);
+    if (p == e || *p != ',') return false;
+    p = skip_spaces(p + 1, e);
+
+    int src1, src2 = -1;
+    long offset = 0;
+    if (op == OP_LOAD || op == OP_STORE) {
+        // off(Rb): deslocamento com sinal opcional, sem espacos ate ')'
+        bool negative = false;
+        if (p < e && (*p == '+' || *p == '-')) negative = (*p++ == '-');
+        const char* digits = p;
+        while (p < e && isdigit((unsigned char)*p)) {
+            offset = offset * 10 + (*p++ - '0');
+            if (offset > (long)INT32_MAX + 1) return false;
+        }
+        if (p == digits) return false;
+        if (negative) offset = -offset;
+        if (offset > INT32_MAX || offset < INT32_MIN) return false;
+        if (p == e || *p != '(') return false;
+        tok = ++p;
+        p = skip_word(p, e);
+        src1 = decode_register(tok, p);
+        if (src1 < 0 || p == e || *p != ')') return false;
+        ++p;
+    } else {
+        tok = p;
+        p = skip_word(p, e);
+        src1 = decode_register(tok, p);
+        if (src1 < 0) return false;
+        p = skip_spaces(p, e);
+        if (p == e || *p != ',') return false;
+        p = skip_spaces(p + 1, e);
+        tok = p;
+        p = skip_word(p, e);
+        src2 = decode_register(tok, p);
+        if (src2 < 0) return false;
+    }
+    if (skip_spaces(p, e) != e) return false;
+
+    out.op = op;
+    out.fu = fu_class(op);
+    out.latency = 0;
+    out.dest = (int16_t)dest;
+    out.src1 = (int16_t)src1;
+    out.src2 = (int16_t)src2;
+    out.offset = (int32_t)offset;
+    return true;
+}
+
+
+// --- Trace Binario ---
+
+static_assert(sizeof(DecodedInst) == 16 && std::is_trivially_copyable<DecodedInst>::value,
+              "o formato binario grava DecodedInst como registro de 16 bytes");
+
+bool valid_record(const DecodedInst& code) {
+    if (code.op < OP_ADD || code.op > OP_STORE || code.fu != fu_class(code.op)) return false;
+    if (code.dest < 0 || code.dest >= NUM_REGS || code.src1 < 0 || code.src1 >= NUM_REGS) return false;
+    if (code.fu == FU_LS) return code.src2 == -1;
+    return code.src2 >= 0 && code.src2 < NUM_REGS;
+}
+
+bool is_binary_trace(const std::string& filename) {
+    // So arquivos regulares: ler o cabecalho de um pipe consumiria o trace
+    struct stat st;
+    if (stat(filename.c_str(), &st) != 0 || !S_ISREG(st.st_mode) || st.st_size < (off_t)sizeof(BinaryTraceHeader)) return false;
+    int f = ::open(filename.c_str(), O_RDONLY);
+    if (f < 0) return false;
+    char magic[8];
+    bool binary = read(f, magic, sizeof(magic)) == (ssize_t)sizeof(magic) && memcmp(magic, BINARY_TRACE_MAGIC, 8) == 0;
+    ::close(f);
+    return binary;
+}
+
+std::unique_ptr<InstructionSource> open_trace(const std::string& filename) {
+    if (is_binary_trace(filename)) {
+        std::unique_ptr<BinaryTrace> binary(new BinaryTrace());
+        if (!binary->open(filename)) return nullptr;
+        return binary;
+    }
+    std::unique_ptr<TraceParser> parser(new TraceParser());
+    if (!parser->open(filename)) return nullptr;
+    return parser;
+}
+
+BinaryTrace::BinaryTrace()
+    : fd(-1), map_base(nullptr), file_size(0), first(nullptr), total(0), pos(0), roi(-1) {}
+
+BinaryTrace::~BinaryTrace() {
+    close();
+}
+
+bool BinaryTrace::open(const std::string& filename) {
+    close();
+    name = filename;
+    fd = ::open(filename.c_str(), O_RDONLY);
+    if (fd < 0) {
+        std::cerr << "Erro ao abrir arquivo de instrucoes: " << filename << std::endl;
+        return false;
+    }
+    struct stat st;
+    if (fstat(fd, &st) != 0 || !S_ISREG(st.st_mode) || st.st_size < (off_t)sizeof(BinaryTraceHeader)) {
+        std::cerr << "Trace binario invalido: " << filename << std::endl;
+        close();
+        return false;
+    }
+    file_size = (size_t)st.st_size;
+    void* m = mmap(nullptr, file_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    if (m == MAP_FAILED) {
+        std::cerr << "Erro ao mapear trace binario: " << filename << std::endl;
+        close();
+        return false;
+    }
+    madvise(m, file_size, MADV_SEQUENTIAL);
+    map_base = (const char*)m;
+
+    BinaryTraceHeader header;
+    memcpy(&header, map_base, sizeof(header));
+    if (memcmp(header.magic, BINARY_TRACE_MAGIC, 8) != 0 || header.record_size != sizeof(DecodedInst)) {
+        std::cerr << "Trace binario invalido: " << filename << std::endl;
+        close();
+        return false;
+    }
+    if (header.version != BINARY_TRACE_VERSION && header.version != 1) {
+        std::cerr << "Versao de trace binario nao suportada (" << header.version << "): " << filename << std::endl;
+        close();
+        return false;
+    }
+    if (header.count != (file_size - sizeof(header)) / sizeof(DecodedInst) ||
+        (file_size - sizeof(header)) % sizeof(DecodedInst) != 0) {
+        std::cerr << "Trace binario truncado ou corrompido: " << filename << std::endl;
+        close();
+        return false;
+    }
+    first = (const DecodedInst*)(map_base + sizeof(header));
+    total = (size_t)header.count;
+    // Marcador logo depois da ultima instrucao (roi = total) vale, como no texto
+    if (header.version == 1 && header.roi == 0) header.roi = BINARY_TRACE_NO_ROI;
+    roi = (header.roi <= total) ? (long)header.roi : -1;
+    return true;
+}
+
+void BinaryTrace::close() {
+    if (map_base) munmap((void*)map_base, file_size);
+    if (fd >= 0) ::close(fd);
+    fd = -1;
+    map_base = nullptr;
+    file_size = 0;
+    first = nullptr;
+    total = 0;
+    pos = 0;
+    roi = -1;
+}
+
+bool BinaryTrace::next(DecodedInst& out) {
+    while (pos < total) {
+        const DecodedInst& code = first[pos++];
+        if (valid_record(code)) {
+            out = code;
+            return true;
+        }
+        std::cerr << name << ": registro " << pos - 1 << " invalido (ignorando)" << std::endl;
+    }
+    return false;
+}
+
+bool BinaryTrace::tell(uint64_t& offset, int& line) const {
+    if (fd < 0) return false;
+    offset = pos;
+    line = 0;
+    return true;
+}
+
+bool BinaryTrace::seek(uint64_t offset, int /*line*/) {
+    if (fd < 0 || offset > total) return false;
+    pos = (size_t)offset;
+    return true;
+}
+
+
+// --- Conversao Texto -> Binario ---
+
+bool BinaryTraceWriter::open(const std::string& filename) {
+    name = filename;
+    records = 0;
+    out.open(filename, std::ios::binary);
+    if (!out) {
+        std::cerr << "Erro ao criar trace binario: " << filename << std::endl;
+        return false;
+    }
+    // Cabecalho provisorio; o total so e conhecido no fim
+    BinaryTraceHeader header = BinaryTraceHeader();
+    out.write((const char*)&header, sizeof(header));
+    block.reserve(READ_CHUNK / sizeof(DecodedInst));
+    return true;
+}
+
+// Registros em blocos, para nao fazer uma escrita por instrucao
+void BinaryTraceWriter::write(const DecodedInst& code) {
+    DecodedInst record = DecodedInst();   // bytes de alinhamento zerados: arquivo reprodutivel
+    record.op = code.op;
+    record.fu = code.fu;
+    record.dest = code.dest;
+    record.src1 = code.src1;
+    record.src2 = code.src2;
+    record.offset = code.offset;
+    block.push_back(record);
+    ++records;
+    if (block.size() == block.capacity()) {
+        out.write((const char*)block.data(), block.size() * sizeof(DecodedInst));
+        block.clear();
+    }
+}
+
+bool BinaryTraceWriter::finish() {
+    if (!block.empty()) out.write((const char*)block.data(), block.size() * sizeof(DecodedInst));
+    block.clear();
+
+    BinaryTraceHeader header = BinaryTraceHeader();
+    memcpy(header.magic, BINARY_TRACE_MAGIC, 8);
+    header.version = BINARY_TRACE_VERSION;
+    header.record_size = sizeof(DecodedInst);
+    header.count = (uint64_t)records;
+    header.roi = roi >= 0 ? (uint64_t)roi : BINARY_TRACE_NO_ROI;
+    out.seekp(0);
+    out.write((const char*)&header, sizeof(header));
+    out.flush();
+    if (!out) {
+        std::cerr << "Erro ao gravar trace binario: " << name << std::endl;
+        return false;
+    }
+    return true;
+}
+
+bool convert_trace(const std::string& text_file, const std::string& binary_file, long& records) {
+    records = 0;
+    if (is_binary_trace(text_file)) {
+        std::cerr << "O arquivo ja e um trace binario: " << text_file << std::endl;
+        return false;
+    }
+    TraceParser parser;
+    if (!parser.open(text_file)) return false;
+    BinaryTraceWriter writer;
+    if (!writer.open(binary_file)) return false;
+    DecodedInst code;
+    while (parser.next(code)) writer.write(code);
+    writer.set_roi(parser.roi_start());
+    records = writer.written();
+    return writer.finish();
+}
@@ -0,0 +1,273 @@
+#ifndef TRACE_H
+#define TRACE_H
+
+#include <string>
+#include <vector>
+#include <memory>
+#include <cstddef>
+#include <cstdint>
+#include <fstream>
+
+// --- Banco de Registradores ---
+// Registradores Fn ocupam os indices [0, 128) e Rn os indices [128, 256)
+#define MAX_BANK_REGS 128
+#define R_REG_BASE MAX_BANK_REGS
+#define NUM_REGS (2 * MAX_BANK_REGS)
+
+// Operacao decodificada (OP_NONE = estacao nunca usada)
+enum OpCode : uint8_t {
+    OP_NONE,
+    OP_ADD,
+    OP_SUB,
+    OP_MUL,
+    OP_DIV,
+    OP_LOAD,
+    OP_STORE
+};
+
+// Classe de unidade funcional que executa a operacao
+enum FuClass : uint8_t {
+    FU_ADD,   // ADD, SUB
+    FU_MUL,   // MUL, DIV
+    FU_LS     // LOAD, STORE
+};
+
+// Instrucao pre-decodificada em load_instructions (registro compacto de 16 bytes).
+// Os estagios despacham sobre estes campos, sem nenhuma operacao com strings.
+struct DecodedInst {
+    OpCode op;
+    FuClass fu;
+    uint16_t latency;  // latencia ja resolvida para a operacao
+    int16_t dest;      // registrador destino (ou valor a gravar, no STORE)
+    int16_t src1;      // primeiro operando (registrador base no LOAD/STORE)
+    int16_t src2;      // segundo operando (-1 no LOAD/STORE)
+    int32_t offset;    // deslocamento imediato do LOAD/STORE
+};
+
+const char* op_name(OpCode op);
+FuClass fu_class(OpCode op);
+
+// Decodifica o nome "Fn"/"Rn" em [p, e) no indice do banco; -1 se invalido
+int decode_register(const char* p, const char* e);
+
+// --- Fonte de Instrucoes ---
+// Entrega instrucoes decodificadas sob demanda, em ordem de programa.
+class InstructionSource {
+public:
+    virtual ~InstructionSource() {}
+    // Retorna false quando nao ha mais instrucoes
+    virtual bool next(DecodedInst& out) = 0;
+
+    // Posicao do proximo registro (deslocamento e linha), usada nos checkpoints.
+    // Retornam false se a fonte nao sabe informar ou reposicionar.
+    virtual bool tell(uint64_t& /*offset*/, int& /*line*/) const { return false; }
+    virtual bool seek(uint64_t /*offset*/, int /*line*/) { return false; }
+
+    // Tamanho do arquivo de origem (conferido ao restaurar) e total de
+    // instrucoes, se conhecido de antemao (-1 = so no fim da leitura)
+    virtual uint64_t size_bytes() const { return 0; }
+    virtual long count() const { return -1; }
+
+    // Indice da primeira instrucao da regiao de interesse (marcador '#@roi'),
+    // ou -1 se nao ha marcador ou a leitura ainda nao passou por ele
+    virtual long roi_start() const { return -1; }
+};
+
+class BinaryTrace;
+
+// --- Programa Decodificado ---
+// Trace inteiro ja decodificado; pode ser compartilhado (somente leitura)
+// entre varios simuladores. Os registros ficam em 'code' (trace em texto) ou
+// direto no mapeamento de um trace binario, sem copia.
+struct Program {
+    std::string name;
+    std::vector<DecodedInst> code;
+    std::unique_ptr<BinaryTrace> binary;
+    const DecodedInst* records = nullptr;
+    size_t size = 0;
+    long roi = -1;          // ver InstructionSource::roi_start
+    int f_regs = 0;         // registradores usados em cada banco (ver registers_used)
+    int r_regs = 0;
+
+    Program();
+    ~Program();
+};
+
+// Le e decodifica o trace inteiro (texto ou binario). Retorna false se o arquivo nao abrir.
+bool load_program(const std::string& filename, Program& program);
+
+// Registradores usados por 'count' registros: maior numero + 1 em cada banco (0 = nenhum)
+void registers_used(const DecodedInst* records, size_t count, int& f_regs, int& r_regs);
+
+// Fonte que percorre um Program compartilhado
+class ProgramSource : public InstructionSource {
+public:
+    explicit ProgramSource(std::shared_ptr<const Program> program)
+        : program(std::move(program)), pos(0) {}
+    bool next(DecodedInst& out) override {
+        if (pos >= program->size) return false;
+        out = program->records[pos++];
+        return true;
+    }
+    bool tell(uint64_t& offset, int& line) const override {
+        offset = pos;
+        line = 0;
+        return true;
+    }
+    bool seek(uint64_t offset, int /*line*/) override {
+        if (offset > program->size) return false;
+        pos = (size_t)offset;
+        return true;
+    }
+    long count() const override { return (long)program->size; }
+    long roi_start() const override { return program->roi; }
+
+private:
+    std::shared_ptr<const Program> program;
+    size_t pos;
+};
+
+// --- Leitor de Traces em Texto ---
+// Le o arquivo via mmap (ou em blocos grandes, quando nao e um arquivo
+// regular) e decodifica linha a linha sem alocar memoria por linha.
+// Gramatica aceita (sem diferenciar maiusculas), com comentarios a partir de '#':
+//   OP   Rd, Rs, Rt        (ADD, SUB, MUL, DIV)
+//   LOAD/STORE Rd, off(Rb)
+// O comentario "#@roi" marca o inicio da regiao de interesse: a primeira
+// instrucao da linha, ou das seguintes (ver fast_forward em config.h).
+class TraceParser : public InstructionSource {
+public:
+    TraceParser();
+    ~TraceParser();
+
+    bool open(const std::string& filename);
+    // Texto ja em memoria (copiado); 'filename' so aparece nas mensagens de erro
+    void open_text(const std::string& text, const std::string& filename);
+    void close();
+
+    // Decodifica a proxima instrucao valida (latencia fica em 0, a cargo do
+    // simulador). Linhas invalidas sao reportadas com o numero da linha e
+    // ignoradas. Retorna false no fim do arquivo.
+    bool next(DecodedInst& out) override;
+
+    // Deslocamento em bytes do inicio da proxima linha. O reposicionamento so
+    // e possivel em arquivos mapeados (nao em pipes).
+    bool tell(uint64_t& offset, int& line) const override;
+    bool seek(uint64_t offset, int line) override;
+
+    uint64_t size_bytes() const override { return file_size; }
+    // Conhecido quando a leitura passa pelo marcador (so lendo desde o inicio)
+    long roi_start() const override { return roi; }
+
+    int line_number() const { return line_no; }
+    int error_count() const { return errors; }
+
+private:
+    int fd;
+    const char* map_base;      // arquivo inteiro mapeado (nullptr no modo em blocos)
+    size_t file_size;
+    const char* cur;
+    const char* end;
+    std::vector<char> buffer;  // modo em blocos (pipes, /dev/stdin)
+    uint64_t buffer_offset;    // posicao no arquivo do inicio de 'buffer'
+    bool eof;
+    int line_no;
+    int errors;
+    long returned;             // instrucoes ja entregues por next()
+    long roi;
+    std::string name;
+
+    bool refill();
+    bool parse_line(const char* p, const char* e, DecodedInst& out);
+
+    TraceParser(const TraceParser&) = delete;
+    TraceParser& operator=(const TraceParser&) = delete;
+};
+
+// --- Trace Binario ---
+// Cabecalho fixo seguido de 'count' registros DecodedInst de 16 bytes, na
+// ordem nativa da maquina (como os checkpoints) e com a latencia em 0. O
+// arquivo e mapeado e os registros sao lidos direto do mapeamento: abrir um
+// trace de qualquer tamanho nao decodifica nem copia nada.
+#define BINARY_TRACE_MAGIC "TOMATRCB"
+#define BINARY_TRACE_VERSION 2      // versao 1: roi = 0 significava sem marcador
+#define BINARY_TRACE_NO_ROI UINT64_MAX
+
+struct BinaryTraceHeader {
+    char magic[8];
+    uint32_t version;
+    uint32_t record_size;   // sizeof(DecodedInst) de quem gravou
+    uint64_t count;         // numero de registros
+    uint64_t roi;           // primeira instrucao da regiao de interesse (BINARY_TRACE_NO_ROI = sem marcador)
+};
+
+class BinaryTrace : public InstructionSource {
+public:
+    BinaryTrace();
+    ~BinaryTrace();
+
+    // Mapeia o arquivo e confere cabecalho e tamanho
+    bool open(const std::string& filename);
+    void close();
+
+    // Registros invalidos (arquivo corrompido) sao reportados e ignorados
+    bool next(DecodedInst& out) override;
+
+    // Posicao = indice do proximo registro
+    bool tell(uint64_t& offset, int& line) const override;
+    bool seek(uint64_t offset, int line) override;
+
+    uint64_t size_bytes() const override { return file_size; }
+    long count() const override { return (long)total; }
+    long roi_start() const override { return roi; }
+    const DecodedInst* records() const { return first; }
+
+private:
+    int fd;
+    const char* map_base;
+    size_t file_size;
+    const DecodedInst* first;
+    size_t total;
+    size_t pos;
+    long roi;
+    std::string name;
+
+    BinaryTrace(const BinaryTrace&) = delete;
+    BinaryTrace& operator=(const BinaryTrace&) = delete;
+};
+
+// Grava um trace binario registro a registro (em blocos); o cabecalho recebe
+// o total em finish()
+class BinaryTraceWriter {
+public:
+    BinaryTraceWriter() : records(0), roi(-1) {}
+    bool open(const std::string& filename);
+    void write(const DecodedInst& code);
+    void set_roi(long index) { roi = index; }
+    bool finish();
+    long written() const { return records; }
+
+private:
+    std::ofstream out;
+    std::vector<DecodedInst> block;
+    long records;
+    long roi;
+    std::string name;
+};
+
+// Registro com operacao e registradores dentro dos limites do simulador?
+bool valid_record(const DecodedInst& code);
+
+// Arquivo regular que comeca com BINARY_TRACE_MAGIC?
+bool is_binary_trace(const std::string& filename);
+
+// Abre o trace (texto ou binario, pelo cabecalho) para leitura sob demanda.
+// Retorna nullptr se nao abrir.
+std::unique_ptr<InstructionSource> open_trace(const std::string& filename);
+
+// Converte um trace em texto (mesma gramatica do TraceParser) para o formato
+// binario. Linhas invalidas sao reportadas e ficam de fora; 'records' recebe
+// o numero de instrucoes gravadas. O marcador "#@roi" vai para o cabecalho.
+bool convert_trace(const std::string& text_file, const std::string& binary_file, long& records);
+
+#endif // TRACE_H
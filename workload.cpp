@@ -0,0 +1,244 @@
+#include "workload.h"
+#include <iostream>
+#include <fstream>
+#include <random>
+#include <algorithm>
+#include <cstdlib>
+#include <climits>
+#include <cerrno>
+
+// --- Leitura dos Parametros ---
+
+namespace {
+
+const char* MIX_NAMES[6] = {"add", "sub", "mul", "div", "load", "store"};
+const OpCode MIX_OPS[6] = {OP_ADD, OP_SUB, OP_MUL, OP_DIV, OP_LOAD, OP_STORE};
+
+bool to_long(const std::string& text, long& out) {
+    if (text.empty()) return false;
+    char* end = nullptr;
+    errno = 0;
+    out = std::strtol(text.c_str(), &end, 10);
+    return *end == '\0' && errno == 0;
+}
+
+bool to_double(const std::string& text, double& out) {
+    if (text.empty()) return false;
+    char* end = nullptr;
+    out = std::strtod(text.c_str(), &end);
+    return *end == '\0';
+}
+
+// "add=25,sub=10,...": operacoes omitidas ficam com peso 0
+bool parse_mix(const std::string& text, int mix[6]) {
+    int weights[6] = {0, 0, 0, 0, 0, 0};
+    int total = 0;
+    size_t start = 0;
+    for (;;) {
+        size_t comma = text.find(',', start);
+        std::string item = text.substr(start, comma == std::string::npos ? std::string::npos : comma - start);
+        size_t eq = item.find('=');
+        long weight = 0;
+        int op = -1;
+        for (int k = 0; k < 6 && eq != std::string::npos; ++k) {
+            if (item.compare(0, eq, MIX_NAMES[k]) == 0) op = k;
+        }
+        if (op < 0 || !to_long(item.substr(eq + 1), weight) || weight < 0 || weight > 1000000) {
+            std::cerr << "Peso invalido em mix: " << item << " (use add=N,sub=N,mul=N,div=N,load=N,store=N)" << std::endl;
+            return false;
+        }
+        weights[op] = (int)weight;
+        total += (int)weight;
+        if (comma == std::string::npos) break;
+        start = comma + 1;
+    }
+    if (total == 0) {
+        std::cerr << "mix sem nenhuma operacao com peso positivo" << std::endl;
+        return false;
+    }
+    for (int k = 0; k < 6; ++k) mix[k] = weights[k];
+    return true;
+}
+
+}
+
+bool WorkloadParams::set(const std::string& assignment) {
+    size_t eq = assignment.find('=');
+    if (eq == std::string::npos) {
+        std::cerr << "Esperado chave=valor: " << assignment << std::endl;
+        return false;
+    }
+    std::string key = assignment.substr(0, eq);
+    std::string value = assignment.substr(eq + 1);
+    long n = 0;
+    double v = 0.0;
+
+    if (key == "mix") return parse_mix(value, mix);
+    if (key == "count" || key == "seed" || key == "chains" || key == "depth" || key == "footprint") {
+        long low = (key == "seed") ? 0 : 1;
+        long high = (key == "chains") ? 120 : (key == "footprint") ? (1L << 30) : LONG_MAX;
+        if (!to_long(value, n) || n < low || n > high) {
+            std::cerr << "Valor invalido para " << key << " (inteiro de " << low << " a " << high << "): " << value << std::endl;
+            return false;
+        }
+        if (key == "count") count = n;
+        else if (key == "seed") seed = (uint64_t)n;
+        else if (key == "chains") chains = (int)n;
+        else if (key == "depth") depth = n;
+        else footprint = n;
+        return true;
+    }
+    if (key == "locality" || key == "alias") {
+        if (!to_double(value, v) || v < 0.0 || v > 1.0) {
+            std::cerr << "Valor invalido para " << key << " (probabilidade de 0 a 1): " << value << std::endl;
+            return false;
+        }
+        (key == "locality" ? locality : alias) = v;
+        return true;
+    }
+    std::cerr << "Parametro de carga desconhecido: " << key << std::endl;
+    return false;
+}
+
+
+// --- Geracao ---
+
+void generate_workload(const WorkloadParams& params, std::vector<DecodedInst>& code) {
+    // mt19937_64 tem a mesma sequencia em qualquer plataforma; as distribuicoes
+    // da biblioteca nao, entao as escolhas sao feitas direto sobre os bits
+    std::mt19937_64 rng(params.seed);
+    auto below = [&rng](uint64_t n) { return rng() % n; };
+    auto chance = [&rng](double p) { return (double)(rng() >> 11) * (1.0 / 9007199254740992.0) < p; };
+
+    int total_weight = 0;
+    for (int w : params.mix) total_weight += w;
+
+    const int CONSTANTS = 8;                    // R1..R8
+    const int BASE = R_REG_BASE;                // R0: base dos LOAD/STORE (sempre 0)
+    uint64_t words = std::max(1L, params.footprint / 8);
+    uint64_t last_word = 0;
+    std::vector<long> recent_stores;            // ultimos enderecos gravados (ate 8)
+    std::vector<long> position(params.chains, 0);
+
+    code.clear();
+    code.reserve(params.count);
+    for (long i = 0; i < params.count; ++i) {
+        int chain = (int)(i % params.chains);
+        int weight = (int)below(total_weight);
+        int k = 0;
+        while (weight >= params.mix[k]) weight -= params.mix[k++];
+
+        DecodedInst inst = DecodedInst();
+        inst.op = MIX_OPS[k];
+        inst.fu = fu_class(inst.op);
+
+        // Operando da cadeia: o resultado anterior ou, no recomeco, uma constante
+        int constant = R_REG_BASE + 1 + (int)below(CONSTANTS);
+        int chained = (position[chain] == 0) ? constant : chain;
+        position[chain] = (position[chain] + 1) % params.depth;
+
+        if (inst.fu == FU_LS) {
+            uint64_t word = chance(params.locality) ? (last_word + 1) % words : below(words);
+            long address = (long)(word * 8);
+            if (inst.op == OP_LOAD && !recent_stores.empty() && chance(params.alias)) {
+                address = recent_stores[below(recent_stores.size())];
+            }
+            last_word = (uint64_t)address / 8;
+            if (inst.op == OP_STORE) {
+                if (recent_stores.size() == 8) recent_stores.erase(recent_stores.begin());
+                recent_stores.push_back(address);
+            }
+            inst.dest = (int16_t)(inst.op == OP_STORE ? chained : chain);
+            inst.src1 = (int16_t)BASE;
+            inst.src2 = -1;
+            inst.offset = (int32_t)address;
+        } else {
+            inst.dest = (int16_t)chain;
+            inst.src1 = (int16_t)chained;
+            inst.src2 = (int16_t)(R_REG_BASE + 1 + (int)below(CONSTANTS));
+        }
+        code.push_back(inst);
+    }
+}
+
+
+// --- Subcomando "gen" ---
+
+namespace {
+
+std::string register_name(int index) {
+    if (index >= R_REG_BASE) return "R" + std::to_string(index - R_REG_BASE);
+    return "F" + std::to_string(index);
+}
+
+bool write_text(const std::string& filename, const std::vector<DecodedInst>& code) {
+    std::ofstream out(filename);
+    if (!out) {
+        std::cerr << "Erro ao criar arquivo de saida: " << filename << std::endl;
+        return false;
+    }
+    for (const DecodedInst& inst : code) {
+        out << op_name(inst.op) << " " << register_name(inst.dest) << ", ";
+        if (inst.fu == FU_LS) out << inst.offset << "(" << register_name(inst.src1) << ")\n";
+        else out << register_name(inst.src1) << ", " << register_name(inst.src2) << "\n";
+    }
+    out.flush();
+    if (!out) {
+        std::cerr << "Erro ao gravar arquivo de saida: " << filename << std::endl;
+        return false;
+    }
+    return true;
+}
+
+void print_generate_usage() {
+    std::cerr << "Uso: simulador gen [CHAVE=VALOR ...] <saida.txt|saida.bin>" << std::endl;
+    std::cerr << "  count=N              instrucoes (padrao 100000)" << std::endl;
+    std::cerr << "  seed=N               semente (mesma semente, mesmo trace)" << std::endl;
+    std::cerr << "  mix=add=N,sub=N,...  pesos de ADD, SUB, MUL, DIV, LOAD e STORE (padrao 25,10,15,5,30,15)" << std::endl;
+    std::cerr << "  chains=N             cadeias de dependencia intercaladas (padrao 4)" << std::endl;
+    std::cerr << "  depth=N              instrucoes dependentes por cadeia antes de recomecar (padrao 8)" << std::endl;
+    std::cerr << "  footprint=N          bytes enderecados pelos LOAD/STORE (padrao 4096)" << std::endl;
+    std::cerr << "  locality=P           chance de acessar a palavra seguinte (padrao 0.8)" << std::endl;
+    std::cerr << "  alias=P              chance de um LOAD ler o endereco de um STORE recente (padrao 0.1)" << std::endl;
+    std::cerr << "Ex: simulador gen count=1000000 chains=1 mix=add=1,div=1 serial.bin" << std::endl;
+}
+
+}
+
+int run_generate(int argc, char* argv[]) {
+    WorkloadParams params;
+    std::string out_file;
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg.find('=') != std::string::npos) {
+            if (!params.set(arg)) return EXIT_FAILURE;
+        } else if (out_file.empty() && !arg.empty() && arg[0] != '-') {
+            out_file = arg;
+        } else if (arg == "--help") {
+            print_generate_usage();
+            return EXIT_SUCCESS;
+        } else {
+            print_generate_usage();
+            return EXIT_FAILURE;
+        }
+    }
+    if (out_file.empty()) {
+        print_generate_usage();
+        return EXIT_FAILURE;
+    }
+
+    std::vector<DecodedInst> code;
+    generate_workload(params, code);
+
+    bool binary = out_file.size() > 4 && out_file.compare(out_file.size() - 4, 4, ".bin") == 0;
+    if (binary) {
+        BinaryTraceWriter writer;
+        if (!writer.open(out_file)) return EXIT_FAILURE;
+        for (const DecodedInst& inst : code) writer.write(inst);
+        if (!writer.finish()) return EXIT_FAILURE;
+    } else if (!write_text(out_file, code)) {
+        return EXIT_FAILURE;
+    }
+    std::cout << code.size() << " instrucoes gravadas em " << out_file << std::endl;
+    return EXIT_SUCCESS;
+}
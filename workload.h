@@ -0,0 +1,37 @@
+#ifndef WORKLOAD_H
+#define WORKLOAD_H
+
+#include <string>
+#include <vector>
+#include <cstdint>
+#include "trace.h"
+
+// --- Parametros de uma Carga Sintetica ---
+// Cada instrucao pertence a uma de 'chains' cadeias de dependencia
+// intercaladas (a instrucao i fica na cadeia i % chains). Dentro da cadeia,
+// cada instrucao le o resultado da anterior; a cada 'depth' instrucoes a
+// cadeia recomeca de registradores constantes (R1..R8, nunca escritos).
+// LOAD/STORE usam base R0 e o endereco inteiro no deslocamento.
+struct WorkloadParams {
+    long count = 100000;        // instrucoes
+    uint64_t seed = 1;
+    int mix[6] = {25, 10, 15, 5, 30, 15};   // pesos de ADD, SUB, MUL, DIV, LOAD, STORE
+    int chains = 4;             // cadeias independentes (1 a 120)
+    long depth = 8;             // instrucoes dependentes antes de recomecar (1 = sem dependencias)
+    long footprint = 4096;      // bytes enderecados pelos LOAD/STORE (palavras de 8 bytes)
+    double locality = 0.8;      // chance de acessar a palavra seguinte ao ultimo acesso
+    double alias = 0.1;         // chance de um LOAD ler o endereco de um STORE recente
+
+    // Aplica "chave=valor" (count, seed, mix, chains, depth, footprint,
+    // locality, alias); mix e "add=25,sub=10,...". Erros vao para std::cerr.
+    bool set(const std::string& assignment);
+};
+
+// Gera as instrucoes decodificadas (deterministico para a mesma semente)
+void generate_workload(const WorkloadParams& params, std::vector<DecodedInst>& code);
+
+// Subcomando "gen": grava a carga em texto ou, com extensao .bin, no formato
+// binario. argv[0] e o proprio "gen". Retorna o codigo de saida do processo.
+int run_generate(int argc, char* argv[]);
+
+#endif // WORKLOAD_H